@@ -0,0 +1,127 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include "BinGeometry.h"
+#include "SharedTables.h"
+#include "SpectralEngine.h"
+
+// The bins of one transform pooled into the bands of a perceptual scale, for detectors that run
+// once per band. The bands are contiguous and cover every bin; where the scale's bands are
+// narrower than a bin, their edges merge, so the low bands of small transforms are single bins.
+// Every bin also knows the two bands whose centres enclose it and its linear weight between
+// them, which spreads band values smoothly back over the bins. Immutable and shared like
+// BinGeometry.
+class BandLayout {
+  public:
+    static constexpr size_t MAX_BANDS = 128;
+
+    BandLayout(const BinGeometry &geometry, DetectionScale scale) {
+        const size_t numBins = geometry.getNumBins();
+        const double binWidth = geometry.sampleRate / (double)geometry.fftSize;
+        const double nyquist = geometry.sampleRate * 0.5;
+
+        bandEdges.push_back(0);
+        for(int step = 1; bandEdges.size() < MAX_BANDS; ++step) {
+            const double edgeFrequency = getEdgeFrequency(scale, step);
+            if(!(edgeFrequency < nyquist))
+                break;
+
+            const auto edge = (uint32_t)std::ceil(edgeFrequency / binWidth);
+            if(edge > bandEdges.back())
+                bandEdges.push_back(edge);
+        }
+        bandEdges.push_back((uint32_t)numBins);
+
+        const size_t numBands = getNumBands();
+        inverseBandSizes.resize(numBands);
+        std::vector<float> centres(numBands);
+        for(size_t band = 0; band < numBands; ++band) {
+            inverseBandSizes[band] = 1.0f / (float)(bandEdges[band + 1] - bandEdges[band]);
+            centres[band] = 0.5f * (float)(bandEdges[band] + bandEdges[band + 1] - 1);
+        }
+
+        // Below the first and above the last centre a bin takes that band's value
+        lowerBands.resize(numBins);
+        upperBands.resize(numBins);
+        upperWeights.resize(numBins);
+        size_t band = 0;
+        for(size_t bin = 0; bin < numBins; ++bin) {
+            while(band + 1 < numBands && centres[band + 1] <= (float)bin)
+                ++band;
+
+            const size_t upper = std::min(band + 1, numBands - 1);
+            lowerBands[bin] = (uint32_t)band;
+            upperBands[bin] = (uint32_t)upper;
+            upperWeights[bin]
+             = upper == band ? 0.0f
+                             : std::clamp(((float)bin - centres[band])
+                                           / (centres[upper] - centres[band]),
+                                          0.0f, 1.0f);
+        }
+    }
+
+    // The shared layout of this geometry and scale. Locks and may allocate, so call it when
+    // preparing, never on the audio thread.
+    static std::shared_ptr<const BandLayout> get(const BinGeometry &geometry,
+                                                 DetectionScale scale) {
+        return SharedTables<BandLayout, std::tuple<double, size_t, int>>::get(
+         {geometry.sampleRate, geometry.fftSize, (int)scale},
+         [&] { return std::make_shared<const BandLayout>(geometry, scale); });
+    }
+
+    size_t getNumBands() const { return bandEdges.size() - 1; }
+
+    // The mean of each band's bins.
+    void averageBins(const float *binValues, float *bandValues) const {
+        for(size_t band = 0; band < getNumBands(); ++band) {
+            float sum = 0.0f;
+            for(uint32_t bin = bandEdges[band]; bin < bandEdges[band + 1]; ++bin)
+                sum += binValues[bin];
+            bandValues[band] = sum * inverseBandSizes[band];
+        }
+    }
+
+    // Bins [beginBin, endBin) interpolated linearly between the centres of the bands.
+    void interpolateBands(const float *bandValues, float *binValues, size_t beginBin,
+                          size_t endBin) const {
+        for(size_t bin = beginBin; bin < endBin; ++bin) {
+            const float lower = bandValues[lowerBands[bin]];
+            const float upper = bandValues[upperBands[bin]];
+            binValues[bin] = lower + upperWeights[bin] * (upper - lower);
+        }
+    }
+
+  private:
+    // The upper edge of the scale's band number step, ascending with step. Bands start at DC.
+    static double getEdgeFrequency(DetectionScale scale, int step) {
+        switch(scale) {
+        case ERB_BANDS: // Glasberg & Moore: ERB number 21.4 log10(1 + 0.00437 f)
+            return (std::pow(10.0, step / 21.4) - 1.0) / 0.00437;
+        case BARK_BANDS: { // Traunmueller: z = 26.81 f / (1960 + f) - 0.53
+            const double z = (double)step;
+            return z < 26.28 ? 1960.0 * (z + 0.53) / (26.28 - z)
+                             : std::numeric_limits<double>::infinity();
+        }
+        case THIRD_OCTAVE_BANDS: // edges halfway between the centres 1 kHz * 2^(k / 3)
+            return 1000.0 * std::pow(2.0, (step - 0.5) / 3.0 - 7.0);
+        case SIXTH_OCTAVE_BANDS: // ... and 1 kHz * 2^(k / 6)
+            return 1000.0 * std::pow(2.0, (step - 0.5) / 6.0 - 7.0);
+        case PER_BIN:
+        default:
+            return std::numeric_limits<double>::infinity();
+        }
+    }
+
+    std::vector<uint32_t> bandEdges; // first bin of every band, then the bin count
+    std::vector<float> inverseBandSizes;
+    std::vector<uint32_t> lowerBands; // per bin
+    std::vector<uint32_t> upperBands;
+    std::vector<float> upperWeights;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "SharedTables.h"
+
+// Where the bins of one transform size sit at one sample rate. Immutable, and shared by every
+// engine and display using the same configuration, so nothing recomputes it per frame or paint.
+struct BinGeometry {
+    // The left edge of the log-frequency displays
+    static constexpr float MIN_DISPLAY_FREQUENCY = 20.0f;
+
+    BinGeometry(double sampleRateHz, size_t fftSizeToUse)
+        : sampleRate(sampleRateHz), fftSize(fftSizeToUse), frequencies(fftSize / 2 + 1),
+          logFrequencies(frequencies.size()), displayPositions(frequencies.size()) {
+        const float logMin = std::log10(MIN_DISPLAY_FREQUENCY);
+        const float logRange = std::log10((float)sampleRate * 0.5f) - logMin;
+
+        for(size_t bin = 0; bin < frequencies.size(); ++bin) {
+            frequencies[bin] = (float)(bin / static_cast<float>(fftSize) * sampleRate);
+            logFrequencies[bin] = std::log10(frequencies[bin]); // -inf at DC
+            const float displayLogFrequency
+             = std::log10(juce::jmax(MIN_DISPLAY_FREQUENCY, frequencies[bin]));
+            displayPositions[bin] = (displayLogFrequency - logMin) / logRange;
+        }
+    }
+
+    // The shared geometry for this configuration. Locks and may allocate, so call it when
+    // preparing or painting, never on the audio thread.
+    static std::shared_ptr<const BinGeometry> get(double sampleRate, size_t fftSize) {
+        return SharedTables<BinGeometry, std::pair<double, size_t>>::get(
+         {sampleRate, fftSize},
+         [&] { return std::make_shared<const BinGeometry>(sampleRate, fftSize); });
+    }
+
+    size_t getNumBins() const { return frequencies.size(); }
+
+    double sampleRate;
+    size_t fftSize;
+    std::vector<float> frequencies;      // bin centres in Hz
+    std::vector<float> logFrequencies;   // log10 of the centres, ascending
+    std::vector<float> displayPositions; // 0 at MIN_DISPLAY_FREQUENCY (and below), 1 at Nyquist
+};
@@ -0,0 +1,278 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <juce_dsp/juce_dsp.h>
+#include <memory>
+#include "SharedTables.h"
+
+// Selects the engine behind RealFFT at build time (see SPECTRIX_FFT_BACKEND in CMakeLists.txt).
+// By default juce::dsp::FFT is only used where it wraps a native library; its portable fallback
+// transforms a full complex sequence of the frame length and is several times slower than the
+// bundled RadixFFT.
+#ifndef SPECTRIX_USE_JUCE_FFT
+    #if((JUCE_MAC || JUCE_IOS) && JUCE_USE_VDSP_FRAMEWORK) || JUCE_IPP_AVAILABLE                 \
+     || JUCE_DSP_USE_INTEL_MKL || JUCE_DSP_USE_SHARED_FFTW || JUCE_DSP_USE_STATIC_FFTW
+        #define SPECTRIX_USE_JUCE_FFT 1
+    #else
+        #define SPECTRIX_USE_JUCE_FFT 0
+    #endif
+#endif
+
+// Real transforms of SIZE samples, all in JUCE's real-only layout: forward() takes the samples
+// in data[0, SIZE) and leaves bins 0 to SIZE / 2 as interleaved (real, imag) pairs in
+// data[0, SIZE + 2); inverse() takes those bins and returns the samples, scaled so that a round
+// trip is the identity. data must hold 2 * SIZE floats; everything past the result is scratch.
+// An instance runs one transform at a time, so channels processed concurrently each need their
+// own.
+namespace FFTBackend {
+    // Owns its plan: some of juce::dsp::FFT's engines (IPP) transform through a work buffer inside
+    // the plan, so a plan shared between threads would race on it.
+    template <size_t SIZE> class JuceFFT {
+      public:
+        void forward(float *data) const { fft.performRealOnlyForwardTransform(data, true); }
+        void inverse(float *data) const { fft.performRealOnlyInverseTransform(data); }
+
+      private:
+        static constexpr int ORDER = std::countr_zero(SIZE);
+
+        juce::dsp::FFT fft{ORDER};
+    };
+
+    // Self-contained radix-2 engine. The real frame is transformed as a complex sequence of
+    // half the length (even samples real, odd samples imaginary) and split into the spectrum
+    // afterwards, which halves the work of a complex transform of the frame. The complex
+    // transform runs in split arrays in the upper half of data, so each butterfly stage is a
+    // unit-stride loop over separate real and imaginary parts that the compiler vectorises. The
+    // twiddles are only read, so all instances of a size share one copy.
+    template <size_t SIZE> class RadixFFT {
+      public:
+        RadixFFT() {
+            static_assert((SIZE & (SIZE - 1)) == 0 && SIZE >= 16, "SIZE must be a power of 2");
+        }
+
+        void forward(float *data) const {
+            const auto &bitReversed = twiddles->bitReversed;
+            const auto &splitCos = twiddles->splitCos;
+            const auto &splitSin = twiddles->splitSin;
+            float *re = data + SIZE;
+            float *im = re + HALF;
+
+            // Even and odd samples as one complex sequence, gathered in bit-reversed order
+            for(size_t j = 0; j < HALF; j += 4) {
+                std::array<float, 4> zr, zi;
+                for(size_t i = 0; i < 4; ++i) {
+                    const size_t n = bitReversed[j + i];
+                    zr[i] = data[2 * n];
+                    zi[i] = data[2 * n + 1];
+                }
+                firstStages(zr, zi, re + j, im + j);
+            }
+
+            runStages(re, im);
+
+            // X[k] = E[k] + W^k O[k], with the transforms of the even and odd samples
+            // E[k] = (Z[k] + Z*[M - k]) / 2 and O[k] = (Z[k] - Z*[M - k]) / 2i, M = SIZE / 2
+            const float dcRe = re[0], dcIm = im[0];
+            for(size_t k = 1; k < HALF; ++k) {
+                const float zr = re[k], zi = im[k];
+                const float cr = re[HALF - k], ci = -im[HALF - k];
+                const float evenRe = 0.5f * (zr + cr), evenIm = 0.5f * (zi + ci);
+                const float oddRe = 0.5f * (zi - ci), oddIm = -0.5f * (zr - cr);
+                const float c = splitCos[k], s = splitSin[k];
+                data[2 * k] = evenRe + c * oddRe + s * oddIm;
+                data[2 * k + 1] = evenIm + c * oddIm - s * oddRe;
+            }
+
+            data[0] = dcRe + dcIm;
+            data[1] = 0.0f;
+            data[SIZE] = dcRe - dcIm;
+            data[SIZE + 1] = 0.0f;
+        }
+
+        void inverse(float *data) const {
+            const auto &bitReversed = twiddles->bitReversed;
+            const auto &splitCos = twiddles->splitCos;
+            const auto &splitSin = twiddles->splitSin;
+            float *re = data + SIZE;
+            float *im = re + HALF;
+
+            // The Nyquist bin shares its place with the scratch; DC and Nyquist are real
+            const float nyquist = data[SIZE];
+            auto binRe = [&](size_t k) { return k == HALF ? nyquist : data[2 * k]; };
+            auto binIm = [&](size_t k) { return (k == 0 || k == HALF) ? 0.0f : data[2 * k + 1]; };
+
+            // Rebuild 2 Z[k] = (X[k] + X*[M - k]) + i W^-k (X[k] - X*[M - k]), conjugated so
+            // the forward butterflies compute the inverse transform
+            for(size_t j = 0; j < HALF; j += 4) {
+                std::array<float, 4> zr, zi;
+                for(size_t i = 0; i < 4; ++i) {
+                    const size_t k = bitReversed[j + i];
+                    const float xr = binRe(k), xi = binIm(k);
+                    const float cr = binRe(HALF - k), ci = -binIm(HALF - k);
+                    const float diffRe = xr - cr, diffIm = xi - ci;
+                    const float c = splitCos[k], s = splitSin[k];
+                    const float oddRe = diffRe * c - diffIm * s;
+                    const float oddIm = diffRe * s + diffIm * c;
+                    zr[i] = (xr + cr) - oddIm;
+                    zi[i] = -((xi + ci) + oddRe);
+                }
+                firstStages(zr, zi, re + j, im + j);
+            }
+
+            runStages(re, im);
+
+            const float scale = 1.0f / (float)SIZE;
+            for(size_t n = 0; n < HALF; ++n) {
+                data[2 * n] = re[n] * scale;
+                data[2 * n + 1] = -im[n] * scale;
+            }
+        }
+
+      private:
+        static constexpr size_t HALF = SIZE / 2;
+
+        // The butterflies of span 1 and 2 fused into one radix-4 step, whose twiddles are
+        // 1 and -i
+        static void firstStages(const std::array<float, 4> &zr, const std::array<float, 4> &zi,
+                                float *re, float *im) {
+            const float a0r = zr[0] + zr[1], a0i = zi[0] + zi[1];
+            const float a1r = zr[0] - zr[1], a1i = zi[0] - zi[1];
+            const float a2r = zr[2] + zr[3], a2i = zi[2] + zi[3];
+            const float a3r = zr[2] - zr[3], a3i = zi[2] - zi[3];
+
+            re[0] = a0r + a2r;
+            im[0] = a0i + a2i;
+            re[2] = a0r - a2r;
+            im[2] = a0i - a2i;
+            re[1] = a1r + a3i;
+            im[1] = a1i - a3r;
+            re[3] = a1r - a3i;
+            im[3] = a1i + a3r;
+        }
+
+        // The remaining stages, two spans per pass as long as two are left
+        void runStages(float *re, float *im) const {
+            size_t h = 4;
+            for(; 4 * h <= HALF; h *= 4)
+                radix4Stage(re, im, h);
+            if(h < HALF)
+                radix2Stage(re, im, h);
+        }
+
+        // The butterflies of span h and 2h in one pass, on each run of 4h values split into its
+        // quarters.
+        void radix4Stage(float *re, float *im, size_t h) const {
+            const auto &stageCos = twiddles->stageCos;
+            const auto &stageSin = twiddles->stageSin;
+            const float *cos1 = stageCos.data() + h, *sin1 = stageSin.data() + h;
+            const float *cos2 = stageCos.data() + 2 * h, *sin2 = stageSin.data() + 2 * h;
+
+            for(size_t j = 0; j < HALF; j += 4 * h)
+                radix4Butterflies(re + j, im + j, re + j + h, im + j + h, re + j + 2 * h,
+                                  im + j + 2 * h, re + j + 3 * h, im + j + 3 * h, cos1, sin1, cos2,
+                                  sin2, h);
+        }
+
+        // The quarters never overlap; saying so lets the compiler vectorise the loop without
+        // versioning it for every pair of them.
+        static forcedinline void
+        radix4Butterflies(float *__restrict aRe, float *__restrict aIm, float *__restrict bRe,
+                          float *__restrict bIm, float *__restrict cRe, float *__restrict cIm,
+                          float *__restrict dRe, float *__restrict dIm, const float *cos1,
+                          const float *sin1, const float *cos2, const float *sin2, size_t h) {
+            for(size_t k = 0; k < h; ++k) {
+                const float w1r = cos1[k], w1i = sin1[k];
+                const float w2r = cos2[k], w2i = sin2[k];
+
+                const float br = bRe[k] * w1r - bIm[k] * w1i;
+                const float bi = bRe[k] * w1i + bIm[k] * w1r;
+                const float dr = dRe[k] * w1r - dIm[k] * w1i;
+                const float di = dRe[k] * w1i + dIm[k] * w1r;
+
+                const float a1r = aRe[k] + br, a1i = aIm[k] + bi;
+                const float b1r = aRe[k] - br, b1i = aIm[k] - bi;
+                const float c1r = cRe[k] + dr, c1i = cIm[k] + di;
+                const float d1r = cRe[k] - dr, d1i = cIm[k] - di;
+
+                // The second span's twiddle for the lower pair is the upper one's times -i
+                const float cr = c1r * w2r - c1i * w2i;
+                const float ci = c1r * w2i + c1i * w2r;
+                const float er = d1r * w2i + d1i * w2r;
+                const float ei = d1i * w2i - d1r * w2r;
+
+                aRe[k] = a1r + cr;
+                aIm[k] = a1i + ci;
+                cRe[k] = a1r - cr;
+                cIm[k] = a1i - ci;
+                bRe[k] = b1r + er;
+                bIm[k] = b1i + ei;
+                dRe[k] = b1r - er;
+                dIm[k] = b1i - ei;
+            }
+        }
+
+        void radix2Stage(float *re, float *im, size_t h) const {
+            const float *cosines = twiddles->stageCos.data() + h;
+            const float *sines = twiddles->stageSin.data() + h;
+
+            for(size_t j = 0; j < HALF; j += 2 * h) {
+                float *topRe = re + j, *topIm = im + j;
+                float *bottomRe = topRe + h, *bottomIm = topIm + h;
+
+                for(size_t k = 0; k < h; ++k) {
+                    const float tr = bottomRe[k] * cosines[k] - bottomIm[k] * sines[k];
+                    const float ti = bottomRe[k] * sines[k] + bottomIm[k] * cosines[k];
+                    bottomRe[k] = topRe[k] - tr;
+                    bottomIm[k] = topIm[k] - ti;
+                    topRe[k] += tr;
+                    topIm[k] += ti;
+                }
+            }
+        }
+
+        struct Twiddles {
+            std::array<float, HALF> stageCos{}, stageSin{};
+            std::array<float, HALF> splitCos, splitSin;
+            std::array<uint32_t, HALF> bitReversed;
+
+            Twiddles() {
+                // Each index reverses to its upper bits' reversal shifted down, with its lowest
+                // bit moved to the top
+                constexpr int bits = std::countr_zero(HALF);
+                bitReversed[0] = 0;
+                for(size_t i = 1; i < HALF; ++i)
+                    bitReversed[i]
+                     = (bitReversed[i >> 1] >> 1) | ((uint32_t)(i & 1) << (bits - 1));
+
+                // The stage with butterfly span h reads its twiddles e^(-i pi k / h) at [h + k]
+                for(size_t h = 1; h < HALF; h *= 2)
+                    for(size_t k = 0; k < h; ++k) {
+                        const double angle
+                         = juce::MathConstants<double>::pi * (double)k / (double)h;
+                        stageCos[h + k] = (float)std::cos(angle);
+                        stageSin[h + k] = (float)-std::sin(angle);
+                    }
+
+                for(size_t k = 0; k < HALF; ++k) {
+                    const double angle
+                     = juce::MathConstants<double>::twoPi * (double)k / (double)SIZE;
+                    splitCos[k] = (float)std::cos(angle);
+                    splitSin[k] = (float)std::sin(angle);
+                }
+            }
+        };
+
+        std::shared_ptr<const Twiddles> twiddles = SharedTables<Twiddles, size_t>::get(
+         SIZE, [] { return std::make_shared<const Twiddles>(); });
+    };
+} // namespace FFTBackend
+
+#if SPECTRIX_USE_JUCE_FFT
+template <size_t SIZE> using RealFFT = FFTBackend::JuceFFT<SIZE>;
+#else
+template <size_t SIZE> using RealFFT = FFTBackend::RadixFFT<SIZE>;
+#endif
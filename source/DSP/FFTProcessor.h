@@ -3,220 +3,507 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdio>
+#include <memory>
 #include <array>
+#include <atomic>
+#include <span>
 #include <juce_dsp/juce_dsp.h>
+#include "BinGeometry.h"
+#include "CacheLine.h"
 #include "CircularBuffer.h"
+#include "FFTBackend.h"
+#include "SharedTables.h"
+#include "SpectralEngine.h"
+#include "TripleBuffer.h"
+#include "WorkerPool.h"
 #include "juce_core/juce_core.h"
 #include "juce_core/system/juce_PlatformDefs.h"
 
-template <size_t FFT_SIZE = 512, size_t NUM_CHANNELS = 2> class FFTProcessor {
+template <size_t FFT_SIZE = 512, size_t NUM_CHANNELS = 2>
+class FFTProcessor : public SpectralEngine {
   public:
-    FFTProcessor()
-        : hopSize(FFT_SIZE / 4),
-          window(FFT_SIZE, juce::dsp::WindowingFunction<float>::blackmanHarris, false),
-          fft((int)log2(FFT_SIZE)) {
+    FFTProcessor() {
         static_assert((FFT_SIZE & (FFT_SIZE - 1)) == 0, "FFT_SIZE must be a power of 2");
         static_assert(FFT_SIZE >= 64, "FFT_SIZE must be at least 64");
         static_assert(NUM_CHANNELS > 0 && NUM_CHANNELS <= 8,
                       "NUM_CHANNELS must be between 1 and 8");
-        computeWindowGain();
-        computeWindowCompensation();
+        setWindowTables();
+        setProcessingGroups({});
     }
 
     ~FFTProcessor() = default;
 
-    void virtual prepareToPlay(double sampleRate) {
-        for(auto &buf : OLABuffers)
-            buf.fill(0.0f);
+    void prepareToPlay(double sampleRate, size_t overlapFactor) override {
+        jassert(juce::isPowerOfTwo(overlapFactor) && overlapFactor >= 2
+                && overlapFactor <= FFT_SIZE / 2);
+        this->sampleRate = sampleRate;
+        hopSize = FFT_SIZE / overlapFactor;
+        setWindowTables();
+        binGeometry = BinGeometry::get(sampleRate, FFT_SIZE);
+        reset();
+    }
 
-        for(auto &buf : fftBuffers)
-            buf.fill(0.0f);
+    void reset() override {
+        for(auto &buffers : channelBuffers) {
+            buffers.fftBuffer.fill(0.0f);
+            buffers.olaBuffer.fill(0.0f);
+            buffers.olaStart = 0;
+            buffers.quietSamples = 0;
+            buffers.frameReady = false;
+            buffers.frameSilent = false;
+            buffers.groupActive = false;
+            buffers.inputFifo.clear();
+            buffers.outputFifo.clear();
+        }
 
-        for(auto &fifo : inputFifos)
-            fifo.clear();
+        // Publish a silent frame rather than clearing the slots, which the UI may be reading
+        unprocessedMagnitudes.write().fill(0.0f);
+        processedMagnitudes.write().fill(0.0f);
+        gainReductions.write().fill(0.0f);
+        unprocessedMagnitudes.publish();
+        processedMagnitudes.publish();
+        gainReductions.publish();
+    }
 
-        for(auto &fifo : outputFifos)
-            fifo.clear();
+    void processBlock(juce::AudioBuffer<float> &buffer) override {
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), (int)NUM_CHANNELS);
+
+        jassert(buffer.getNumChannels() <= (int)NUM_CHANNELS);
+        numActiveChannels = juce::jmax(1, numChannels);
+
+        beginBlock(numSamples);
+
+        // Walk the block in runs that end on the next hop boundary, so the FIFOs are filled and
+        // drained in contiguous chunks and computeFFT only runs when a frame is complete. All
+        // channels advance in lockstep: at a boundary beginHop() latches the settings once, then
+        // every channel's frame is computed. The sample that completes a frame is popped after
+        // the frame, exactly as the per-sample path did, so the output is bit-identical.
+        int position = 0;
+        while(position < numSamples) {
+            const size_t samplesUntilFrame
+             = FFT_SIZE - std::min(channelBuffers[0].inputFifo.size(), FFT_SIZE - 1);
+            const int runLength
+             = (int)std::min<size_t>(samplesUntilFrame, (size_t)(numSamples - position));
+            const bool completesFrame = (size_t)runLength == samplesUntilFrame;
+
+            for(int ch = 0; ch < numChannels; ++ch) {
+                auto *data = buffer.getWritePointer(ch) + position;
+                trackSilence(ch, data, runLength);
+                channelBuffers[ch].inputFifo.push(data, runLength);
+                channelBuffers[ch].outputFifo.pop(data, completesFrame ? runLength - 1 : runLength);
+            }
 
-        processedMagnitudes.fill(0.0f);
-        unprocessedMagnitudes.fill(0.0f);
-        this->sampleRate = sampleRate;
+            if(completesFrame) {
+                beginHop(position + runLength - 1);
+                processFrames(numChannels);
+                for(int ch = 0; ch < numChannels; ++ch)
+                    buffer.getWritePointer(ch)[position + runLength - 1]
+                     = channelBuffers[ch].outputFifo.pop();
+            }
+
+            position += runLength;
+        }
     }
 
-    void processBlock(juce::AudioBuffer<float> &buffer) {
-        const int numSamples = buffer.getNumSamples();
-        const int numChannels = buffer.getNumChannels();
+    double getSampleRate() const override { return sampleRate; }
 
-        jassert(numChannels <= NUM_CHANNELS);
+    // Each snapshot has a single reader: the spectrum displays and the gain reduction view.
+    std::span<const float> getProcessedMagnitudes() override { return processedMagnitudes.read(); }
 
-        for(int ch = 0; ch < numChannels; ++ch) {
-            auto *data = buffer.getWritePointer(ch);
+    std::span<const float> getUnprocessedMagnitudes() override {
+        return unprocessedMagnitudes.read();
+    }
 
-            for(int i = 0; i < numSamples; ++i) {
-                inputFifos[ch].push(data[i]);
-                computeFFT(ch);
-                data[i] = outputFifos[ch].pop();
-            }
-        }
+    std::span<const float> getGainReductionArray() override { return gainReductions.read(); }
+
+    size_t getFFTSize() const override { return FFT_SIZE; }
+
+    size_t getHopSize() const override { return hopSize; }
+
+    // The first output sample of a frame leaves as its last input sample arrives.
+    int getLatencySamples() const override { return (int)FFT_SIZE - 1; }
+
+    // Only spend time on the analysis taps while something displays them.
+    void setAnalysisEnabled(bool shouldAnalyse) override {
+        analysisEnabled.store(shouldAnalyse, std::memory_order_relaxed);
     }
 
-    double getSampleRate() const { return sampleRate; }
+    void setWorkerPool(WorkerPool *pool) override { workerPool = pool; }
+
+    // Adjacent channels whose frames are processed together, see setProcessingGroups().
+    struct ChannelGroup {
+        int firstChannel = 0;
+        int numChannels = 1;
+    };
+
+    // Processes bins [beginBin, endBin) of the frames of one channel group (getFFTBuffer()).
+    // With a worker pool, different groups, and for large frames disjoint bin ranges of one
+    // group, run concurrently. When analyse is set, implementations fill each channel's analysis
+    // for those bins from the values they already compute for the frame.
+    virtual void processFFTBins(const ChannelGroup &group, bool analyse, size_t beginBin,
+                                size_t endBin)
+     = 0;
 
-    const std::array<float, FFT_SIZE / 2 + 1> &getProcessedMagnitudes() const {
-        return processedMagnitudes;
+    // Replaces processFFTBins for a group whose input is below SILENCE_THRESHOLD on every
+    // channel, which is then neither transformed nor resynthesised. Implementations must leave
+    // their state as if all-zero spectra had been processed, and fill the analysis as
+    // processFFTBins would. A silent channel in a group with signal gets an all-zero spectrum.
+    virtual void skipSilentFrame(const ChannelGroup &group, bool analyse) = 0;
+
+  protected:
+    static constexpr size_t NUM_BINS = FFT_SIZE / 2 + 1;
+    static constexpr float SILENCE_THRESHOLD = 3.16227766e-8f; // -150 dBFS
+
+    // Called at the start of every block, before any of its samples are consumed.
+    virtual void beginBlock(int /*numSamples*/) {}
+    // Called once per hop, before the frames of all channels for that hop are processed, with the
+    // index within the current block of the sample that completed the frame.
+    virtual void beginHop(int /*samplePosition*/) {}
+    // Called before the bin ranges of a group's frames that will be processed; the calls for
+    // different groups may run concurrently.
+    virtual void beginFrame(const ChannelGroup & /*group*/) {}
+
+    // Splits the channels into runs processed together, e.g. to share one detector. Groups run
+    // past the last channel are cut short; an empty list processes every channel on its own.
+    // Call from beginBlock(), beginHop() or while processing is stopped.
+    void setProcessingGroups(std::span<const int> groupSizes) {
+        numGroups = 0;
+        int firstChannel = 0;
+        for(const int size : groupSizes) {
+            if(firstChannel >= (int)NUM_CHANNELS)
+                break;
+            const int clippedSize = juce::jmin(size, (int)NUM_CHANNELS - firstChannel);
+            groups[(size_t)numGroups++] = {firstChannel, clippedSize};
+            firstChannel += clippedSize;
+        }
+
+        while(firstChannel < (int)NUM_CHANNELS)
+            groups[(size_t)numGroups++] = {firstChannel++, 1};
     }
 
-    const std::array<float, FFT_SIZE / 2 + 1> &getUnprocessedMagnitudes() const {
-        return unprocessedMagnitudes;
+    std::array<float, FFT_SIZE * 2> &getFFTBuffer(int channel) {
+        return channelBuffers[(size_t)channel].fftBuffer;
     }
 
-    size_t getFFTSize() const { return FFT_SIZE; }
+    // Amplitude spectrum of bins [beginBin, endBin) of a forward transform, scaled so a
+    // full-scale sine reads 1.
+    void computeMagnitudes(const std::array<float, FFT_SIZE * 2> &fftBuffer,
+                           std::array<float, NUM_BINS> &magnitudes, size_t beginBin,
+                           size_t endBin) const {
+        const float scale = (2.0f / FFT_SIZE) / windowCoherentGain;          // normal bins
+        const float dcNyquistScale = (1.0f / FFT_SIZE) / windowCoherentGain; // DC & Nyquist
 
-    virtual void processFFTBins(std::array<float, FFT_SIZE * 2> &fftBuffer) = 0;
+        for(size_t bin = std::max(beginBin, (size_t)1); bin < std::min(endBin, NUM_BINS - 1);
+            ++bin) {
+            const float real = fftBuffer[2 * bin];
+            const float imag = fftBuffer[2 * bin + 1];
+            magnitudes[bin] = std::sqrt(real * real + imag * imag) * scale;
+        }
+
+        if(beginBin == 0)
+            magnitudes[0] = std::abs(fftBuffer[0]) * dcNyquistScale;
+        if(endBin == NUM_BINS)
+            magnitudes[NUM_BINS - 1] = std::abs(fftBuffer[FFT_SIZE]) * dcNyquistScale;
+    }
+
+    // One channel's analysis of the current frame, averaged over the channels once all of them
+    // are done. Every array starts a cache line, so the workers filling different channels or bin
+    // ranges never write to the same line.
+    struct ChannelAnalysis {
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> dryMagnitudes{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> wetMagnitudes{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> gainReductionsDB{};
+    };
+
+    ChannelAnalysis &getChannelAnalysis(int channel) { return channelAnalyses[(size_t)channel]; }
 
   private:
-    void computeFFT(int channel) {
-        if(inputFifos[channel].size() < FFT_SIZE)
+    // Frames of at least this size are also split into bin ranges when a pool is available
+    static constexpr size_t MIN_SPLIT_FFT_SIZE = 16384;
+    static constexpr size_t SPLIT_GRANULARITY = 16; // bins per range are a multiple of this
+    static_assert(SPLIT_GRANULARITY * sizeof(float) % CACHE_LINE_SIZE == 0,
+                  "bin ranges must not share the cache lines of per-bin arrays");
+
+    // Runs the frames of every channel group for the current hop, on the worker pool if there
+    // is one, and joins before the analysis is combined and the output is read.
+    void processFrames(int numChannels) {
+        const bool analyse = analysisEnabled.load(std::memory_order_relaxed);
+
+        // The groups covering this block's channels
+        std::array<ChannelGroup, NUM_CHANNELS> activeGroups;
+        int numActiveGroups = 0;
+        for(int g = 0; g < numGroups && groups[(size_t)g].firstChannel < numChannels; ++g) {
+            auto group = groups[(size_t)g];
+            group.numChannels = juce::jmin(group.numChannels, numChannels - group.firstChannel);
+            activeGroups[(size_t)numActiveGroups++] = group;
+        }
+
+        // Without channels there is nothing to process or publish
+        if(numActiveGroups == 0)
             return;
 
-        jassert(channel < NUM_CHANNELS);
-        auto &inFifo = inputFifos[channel];
-        auto &outFifo = outputFifos[channel];
-        auto &fftBuffer = fftBuffers[channel];
-        auto &olaBuffer = OLABuffers[channel];
+        const int concurrency = workerPool != nullptr ? workerPool->getConcurrency() : 1;
+        const int numRanges = FFT_SIZE >= MIN_SPLIT_FFT_SIZE ? concurrency / numActiveGroups : 1;
+
+        if(concurrency == 1) {
+            for(int g = 0; g < numActiveGroups; ++g)
+                processGroup(activeGroups[(size_t)g], analyse);
+        } else if(numRanges <= 1) {
+            workerPool->run(numActiveGroups,
+                            [&](int g) { processGroup(activeGroups[(size_t)g], analyse); });
+        } else {
+            const size_t rangeSize = (NUM_BINS + (size_t)numRanges - 1) / (size_t)numRanges;
+            const size_t alignedRangeSize
+             = (rangeSize + SPLIT_GRANULARITY - 1) / SPLIT_GRANULARITY * SPLIT_GRANULARITY;
+
+            workerPool->run(numChannels, [&](int ch) { analyseFrame(ch); });
+            workerPool->run(numActiveGroups,
+                            [&](int g) { beginGroup(activeGroups[(size_t)g], analyse); });
+            workerPool->run(numActiveGroups * numRanges, [&](int task) {
+                const auto &group = activeGroups[(size_t)(task / numRanges)];
+                const size_t beginBin = (size_t)(task % numRanges) * alignedRangeSize;
+                if(channelBuffers[(size_t)group.firstChannel].groupActive && beginBin < NUM_BINS)
+                    processFFTBins(group, analyse, beginBin,
+                                   std::min(beginBin + alignedRangeSize, NUM_BINS));
+            });
+            workerPool->run(numChannels, [&](int ch) { synthesiseFrame(ch); });
+        }
 
-        fftBuffer.fill(0.0f);
+        if(analyse)
+            publishAnalysis(numChannels);
+    }
 
-        for(size_t i = 0; i < FFT_SIZE; ++i)
-            fftBuffer[i] = inFifo[i];
+    void processGroup(const ChannelGroup &group, bool analyse) {
+        for(int ch = group.firstChannel; ch < group.firstChannel + group.numChannels; ++ch)
+            analyseFrame(ch);
 
-        window.multiplyWithWindowingTable(fftBuffer.data(), FFT_SIZE);
-        fft.performRealOnlyForwardTransform(fftBuffer.data());
-        storeMagnitudes(fftBuffer, channel, unprocessedMagnitudes);
-        processFFTBins(fftBuffer);
-        storeMagnitudes(fftBuffer, channel, processedMagnitudes);
-        fft.performRealOnlyInverseTransform(fftBuffer.data());
-        window.multiplyWithWindowingTable(fftBuffer.data(), FFT_SIZE);
+        beginGroup(group, analyse);
+        if(channelBuffers[(size_t)group.firstChannel].groupActive)
+            processFFTBins(group, analyse, 0, NUM_BINS);
 
-        for(size_t i = 0; i < FFT_SIZE; ++i)
-            fftBuffer[i] *= windowCompensation[i];
+        for(int ch = group.firstChannel; ch < group.firstChannel + group.numChannels; ++ch)
+            synthesiseFrame(ch);
+    }
 
-        for(size_t i = 0; i < FFT_SIZE; ++i)
-            fftBuffer[i] += olaBuffer[i];
+    // Decides whether the group's bins are processed this hop or the group is skipped as silent.
+    void beginGroup(const ChannelGroup &group, bool analyse) {
+        bool ready = true, silent = true;
+        for(int ch = group.firstChannel; ch < group.firstChannel + group.numChannels; ++ch) {
+            ready = ready && channelBuffers[(size_t)ch].frameReady;
+            silent = silent && channelBuffers[(size_t)ch].frameSilent;
+        }
 
-        for(size_t i = 0; i < hopSize; ++i)
-            outFifo.push(fftBuffer[i]);
+        channelBuffers[(size_t)group.firstChannel].groupActive = ready && !silent;
+        if(!ready)
+            return;
 
-        std::copy(fftBuffer.begin() + hopSize, fftBuffer.begin() + FFT_SIZE, olaBuffer.begin());
-        std::fill(olaBuffer.begin() + (FFT_SIZE - hopSize), olaBuffer.end(), 0.0f);
+        if(silent)
+            skipSilentFrame(group, analyse);
+        else
+            beginFrame(group);
+    }
 
-        for(size_t i = 0; i < hopSize; ++i)
-            inFifo.pop();
+    void analyseFrame(int channel) {
+        jassert(channel < (int)NUM_CHANNELS);
+        auto &buffers = channelBuffers[(size_t)channel];
+        buffers.frameReady = buffers.inputFifo.size() >= FFT_SIZE;
+        if(!buffers.frameReady)
+            return;
+
+        auto &fftBuffer = buffers.fftBuffer;
+
+        // A silent frame contributes nothing to the output: only the overlap-add tail of earlier
+        // frames moves on, so it resumes seamlessly when signal returns.
+        buffers.frameSilent = buffers.quietSamples >= FFT_SIZE;
+        if(buffers.frameSilent) {
+            fftBuffer.fill(0.0f);
+            return;
+        }
+
+        // Window straight out of the FIFO: the mirrored ring hands out the frame contiguously.
+        const auto frame = buffers.inputFifo.latest(FFT_SIZE);
+        juce::FloatVectorOperations::multiply(fftBuffer.data(), frame.data(),
+                                              windows->analysis.data(), (int)FFT_SIZE);
+
+        buffers.fft.forward(fftBuffer.data());
     }
 
-    void storeMagnitudes(const std::array<float, FFT_SIZE * 2> &fftBuffer, int channel, std::array<float, FFT_SIZE / 2 + 1> &magnitudesRef) {
-        juce::SpinLock::ScopedLockType lock(mutex);
+    // Inverse transform, synthesis window and overlap-add in one pass over the frame. The
+    // overlap-add state is a ring that starts a hop later for every frame: its first hop is
+    // complete once this frame is added, leaves as output and is cleared for the frame that will
+    // end there, so nothing is shifted between hops.
+    void synthesiseFrame(int channel) {
+        auto &buffers = channelBuffers[(size_t)channel];
+        if(!buffers.frameReady)
+            return;
 
-        // Use computed window gain instead of hardcoded value
-        const float scale = (2.0f / FFT_SIZE) / windowCoherentGain;          // normal bins
-        const float dcNyquistScale = (1.0f / FFT_SIZE) / windowCoherentGain; // DC & Nyquist
-        const float channelWeight = (NUM_CHANNELS > 1) ? 0.5f : 1.0f;        // average stereo
-
-        auto computeMag = [&](size_t bin) {
-            if(bin == 0) {
-                return std::abs(fftBuffer[0]) * dcNyquistScale * channelWeight;
-            } else if(bin == FFT_SIZE / 2) {
-                return std::abs(fftBuffer[1]) * dcNyquistScale * channelWeight;
-            } else {
-                float real = fftBuffer[2 * bin];
-                float imag = fftBuffer[2 * bin + 1];
-                return std::sqrt(real * real + imag * imag) * scale * channelWeight;
+        auto &fftBuffer = buffers.fftBuffer;
+        auto &olaBuffer = buffers.olaBuffer;
+        auto &olaStart = buffers.olaStart;
+        const bool silent = buffers.frameSilent;
+
+        if(!silent)
+            buffers.fft.inverse(fftBuffer.data());
+
+        // Runs of the frame [begin, end) with their contiguous ring positions
+        auto forEachRun = [&](size_t begin, size_t end, auto &&processRun) {
+            size_t ringIndex = (olaStart + begin) & (FFT_SIZE - 1);
+            while(begin < end) {
+                const size_t length = std::min(end - begin, FFT_SIZE - ringIndex);
+                processRun(fftBuffer.data() + begin, windows->synthesis.data() + begin,
+                           olaBuffer.data() + ringIndex, length);
+                begin += length;
+                ringIndex = 0;
             }
         };
 
-        // For channel 0, store in tempMagnitudes
-        if(channel == 0) {
-            for(size_t i = 0; i <= FFT_SIZE / 2; ++i)
-                tempMagnitudes[i] = computeMag(i);
-
-            // If mono, copy immediately to processedMagnitudes
-            if(NUM_CHANNELS == 1)
-                magnitudesRef = tempMagnitudes;
-        } else if(channel > 0 && NUM_CHANNELS > 1) {
-            // Add subsequent channels to processedMagnitudes
-            for(size_t i = 0; i <= FFT_SIZE / 2; ++i)
-                magnitudesRef[i] = tempMagnitudes[i] + computeMag(i);
-        }
-    }
+        // A silent frame is all zeros, so its output is what the ring already holds
+        forEachRun(0, hopSize, [](float *frame, const float *window, float *ola, size_t n) {
+            for(size_t i = 0; i < n; ++i) {
+                frame[i] = ola[i] + frame[i] * window[i];
+                ola[i] = 0.0f;
+            }
+        });
+        buffers.outputFifo.push(fftBuffer.data(), hopSize);
 
-    void computeWindowGain() {
-        std::array<float, FFT_SIZE> tempWindow;
-        std::fill(tempWindow.begin(), tempWindow.end(), 1.0f);
-        window.multiplyWithWindowingTable(tempWindow.data(), FFT_SIZE);
+        auto accumulate = [](float *frame, const float *window, float *ola, size_t n) {
+            for(size_t i = 0; i < n; ++i)
+                ola[i] += frame[i] * window[i];
+        };
+        if(!silent)
+            forEachRun(hopSize, FFT_SIZE, accumulate);
 
-        // Sum all window coefficients to get coherent gain
-        float sum = 0.0f;
-        for(size_t i = 0; i < FFT_SIZE; ++i) {
-            sum += tempWindow[i];
+        olaStart = (olaStart + hopSize) & (FFT_SIZE - 1);
+        buffers.inputFifo.discard(hopSize);
+    }
+
+    // Averages the channels' analyses in channel order, whichever thread produced them, and hands
+    // the frame to the UI with one index swap each.
+    void publishAnalysis(int numChannels) {
+        for(int ch = 0; ch < numChannels; ++ch) {
+            const auto &analysis = channelAnalyses[(size_t)ch];
+            accumulateMagnitudes(ch, analysis.dryMagnitudes, unprocessedMagnitudes.write());
+            accumulateMagnitudes(ch, analysis.wetMagnitudes, processedMagnitudes.write());
+            accumulateMagnitudes(ch, analysis.gainReductionsDB, gainReductions.write());
         }
 
-        // Coherent gain (for single frequency components)
-        windowCoherentGain = sum / FFT_SIZE;
+        unprocessedMagnitudes.publish();
+        processedMagnitudes.publish();
+        gainReductions.publish();
     }
 
-    void computeWindowCompensation() {
-        std::array<float, FFT_SIZE * 2> overlapSum;
-        overlapSum.fill(0.0f);
-
-        std::array<float, FFT_SIZE> tempWindow;
-        std::fill(tempWindow.begin(), tempWindow.end(), 1.0f);
-        window.multiplyWithWindowingTable(tempWindow.data(), FFT_SIZE);
+    // Counts how long the channel's input has stayed below SILENCE_THRESHOLD. A run holding any
+    // louder sample restarts the count, so a frame is only skipped when all of it is quiet.
+    void trackSilence(int channel, const float *samples, int numSamples) {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+        const bool quiet
+         = range.getStart() > -SILENCE_THRESHOLD && range.getEnd() < SILENCE_THRESHOLD;
+        auto &quietSamples = channelBuffers[(size_t)channel].quietSamples;
+        quietSamples = std::min(quiet ? quietSamples + (size_t)numSamples : 0, FFT_SIZE);
+    }
 
-        for(size_t i = 0; i < FFT_SIZE; ++i) {
-            tempWindow[i] = tempWindow[i] * tempWindow[i];
-        }
+    // Averages this channel's values into the frame being built in the back slot.
+    void accumulateMagnitudes(int channel, const std::array<float, NUM_BINS> &magnitudes,
+                              std::array<float, NUM_BINS> &frame) const {
+        const float channelWeight = 1.0f / (float)numActiveChannels;
+        if(channel == 0)
+            juce::FloatVectorOperations::multiply(frame.data(), magnitudes.data(), channelWeight,
+                                                  (int)NUM_BINS);
+        else
+            juce::FloatVectorOperations::addWithMultiply(frame.data(), magnitudes.data(),
+                                                         channelWeight, (int)NUM_BINS);
+    }
 
-        const size_t numFrames = 8; // Extra frames to ensure steady state
+    // Analysis and synthesis windows for one hop size. The window is always Blackman-Harris and
+    // the size is part of the type, so the hop alone keys the tables every engine shares.
+    struct WindowTables {
+        explicit WindowTables(size_t hop) {
+            juce::dsp::WindowingFunction<float>::fillWindowingTables(
+             analysis.data(), FFT_SIZE, juce::dsp::WindowingFunction<float>::blackmanHarris,
+             false);
 
-        for(size_t frame = 0; frame < numFrames; ++frame) {
-            size_t offset = frame * hopSize;
+            // Sum all window coefficients to get coherent gain (for single frequency components)
+            float sum = 0.0f;
             for(size_t i = 0; i < FFT_SIZE; ++i) {
-                if(offset + i < overlapSum.size()) {
-                    overlapSum[offset + i] += tempWindow[i];
+                sum += analysis[i];
+            }
+            coherentGain = sum / FFT_SIZE;
+
+            std::array<float, FFT_SIZE * 2> overlapSum;
+            overlapSum.fill(0.0f);
+
+            // Every frame starting inside the buffer, so the second half is in steady state
+            const size_t numFrames = overlapSum.size() / hop;
+
+            for(size_t frame = 0; frame < numFrames; ++frame) {
+                size_t offset = frame * hop;
+                for(size_t i = 0; i < FFT_SIZE; ++i) {
+                    if(offset + i < overlapSum.size()) {
+                        overlapSum[offset + i] += analysis[i] * analysis[i];
+                    }
                 }
             }
-        }
 
-        size_t steadyStateStart = FFT_SIZE;
+            size_t steadyStateStart = FFT_SIZE;
 
-        for(size_t i = 0; i < FFT_SIZE; ++i) {
-            float sum = overlapSum[steadyStateStart + i];
-            if(sum > 1e-6f) {
-                windowCompensation[i] = 1.0f / sum;
-            } else {
-                windowCompensation[i] = 1.0f; // Fallback
+            // The synthesis window carries the compensation, so synthesis multiplies only once
+            for(size_t i = 0; i < FFT_SIZE; ++i) {
+                float sum = overlapSum[steadyStateStart + i];
+                const float compensation = sum > 1e-6f ? 1.0f / sum : 1.0f; // 1 as a fallback
+                synthesis[i] = analysis[i] * compensation;
             }
         }
-    }
 
-    const size_t hopSize;
-    juce::dsp::WindowingFunction<float> window;
-    std::array<float, FFT_SIZE> windowCompensation;
-    juce::dsp::FFT fft;
+        std::array<float, FFT_SIZE> analysis;
+        std::array<float, FFT_SIZE> synthesis; // window times overlap compensation
+        float coherentGain = 0.0f;
+    };
 
-    std::array<CircularBuffer<float, FFT_SIZE * 2>, NUM_CHANNELS> inputFifos;
-    std::array<CircularBuffer<float, FFT_SIZE * 2>, NUM_CHANNELS> outputFifos;
-    std::array<std::array<float, FFT_SIZE>, NUM_CHANNELS> OLABuffers;
-    std::array<std::array<float, FFT_SIZE * 2>, NUM_CHANNELS> fftBuffers;
+    void setWindowTables() {
+        const size_t hop = hopSize;
+        windows = SharedTables<WindowTables, size_t>::get(
+         hop, [hop] { return std::make_shared<const WindowTables>(hop); });
+        windowCoherentGain = windows->coherentGain;
+    }
 
-    mutable juce::SpinLock mutex;
-    std::array<float, FFT_SIZE / 2 + 1> processedMagnitudes;
-    std::array<float, FFT_SIZE / 2 + 1> tempMagnitudes;
-    std::array<float, FFT_SIZE / 2 + 1> unprocessedMagnitudes;
-    std::array<float, FFT_SIZE / 2 + 1> tempUnprocessedMagnitudes;
+    size_t hopSize = FFT_SIZE / 4;
+    std::shared_ptr<const WindowTables> windows;
+
+    // Everything one channel's frame reads and writes. Workers process different channels at the
+    // same time, so every channel starts on a cache line of its own: the per-hop buffers and
+    // flags first, then the FIFOs that are also touched between hops.
+    struct alignas(CACHE_LINE_SIZE) ChannelBuffers {
+        std::array<float, FFT_SIZE * 2> fftBuffer;
+        std::array<float, FFT_SIZE> olaBuffer; // a ring, see synthesiseFrame
+        size_t olaStart = 0;
+        size_t quietSamples = 0;
+        bool frameReady = false;  // the hop's frame is being processed
+        bool frameSilent = false; // ... and its input is silent
+        bool groupActive = false; // on a group's first channel: its bins are processed
+        RealFFT<FFT_SIZE> fft;    // per channel, as channels may be transformed concurrently
+
+        alignas(CACHE_LINE_SIZE) CircularBuffer<float, FFT_SIZE> inputFifo;
+        CircularBuffer<float, FFT_SIZE> outputFifo;
+    };
+
+    std::array<ChannelBuffers, NUM_CHANNELS> channelBuffers;
+    std::array<ChannelGroup, NUM_CHANNELS> groups;
+    int numGroups = 0;
+    std::array<ChannelAnalysis, NUM_CHANNELS> channelAnalyses;
+
+    int numActiveChannels = (int)NUM_CHANNELS;
+    WorkerPool *workerPool = nullptr;
+    std::atomic<bool> analysisEnabled{false};
+
+    // Snapshots read by the UI, on cache lines apart from the processing state (see TripleBuffer)
+    TripleBuffer<std::array<float, NUM_BINS>> processedMagnitudes;
+    TripleBuffer<std::array<float, NUM_BINS>> unprocessedMagnitudes;
+    TripleBuffer<std::array<float, NUM_BINS>> gainReductions;
 
   protected:
     float windowCoherentGain = 0.42f; // Computed in constructor
+    std::shared_ptr<const BinGeometry> binGeometry; // at the prepared sample rate, null before
 
     double sampleRate = 44100.0;
 
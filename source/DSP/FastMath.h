@@ -0,0 +1,45 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+// Branch-free float approximations for the per-bin loops. They only use arithmetic, selects and
+// integer/float reinterpretation, so loops calling them auto-vectorise, provided they are inlined.
+namespace FastMath {
+    // log2 of a positive, normal x. Subtracting the bit pattern of sqrt(1/2) before taking the
+    // exponent folds the mantissa into [sqrt(1/2), sqrt(2)) with integer ops only; its logarithm
+    // comes from the atanh series 2(s + s^3/3 + s^5/5 + s^7/7), s = (m - 1) / (m + 1).
+    // Error below 4e-6, i.e. within rounding of the float result.
+    forcedinline float log2(float x) {
+        const auto bits = std::bit_cast<int32_t>(x);
+        const int32_t exponent = (bits - 0x3f3504f3) >> 23;
+        const float mantissa = std::bit_cast<float>(bits - (exponent << 23));
+
+        const float s = (mantissa - 1.0f) / (mantissa + 1.0f);
+        const float s2 = s * s;
+        const float logMantissa
+         = 2.0f * s * (1.0f + s2 * (1.0f / 3.0f + s2 * (1.0f / 5.0f + s2 * (1.0f / 7.0f))));
+        return (float)exponent + logMantissa * 1.44269504f;
+    }
+
+    // 2^x for |x| < 2^31, saturating outside the normal float range. The nearest integer to x
+    // becomes the exponent and the remainder |f| <= 1/2 goes through a degree-6 Taylor series of
+    // e^(f ln 2). Relative error < 3e-7.
+    forcedinline float exp2(float x) {
+        // floor(x + 0.5) without a libm call
+        const float shifted = x + 0.5f;
+        int32_t exponent = (int32_t)shifted;
+        exponent -= (shifted < (float)exponent) ? 1 : 0;
+
+        constexpr float c3 = 1.0f / 6.0f, c4 = 1.0f / 24.0f;
+        constexpr float c5 = 1.0f / 120.0f, c6 = 1.0f / 720.0f;
+        const float y = (x - (float)exponent) * 0.693147181f;
+        const float series
+         = 1.0f + y * (1.0f + y * (0.5f + y * (c3 + y * (c4 + y * (c5 + y * c6)))));
+
+        // Clamping the integer part keeps the result finite and the loop free of float branches
+        exponent = std::clamp(exponent, (int32_t)-126, (int32_t)127);
+        return series * std::bit_cast<float>((exponent + 127) << 23);
+    }
+} // namespace FastMath
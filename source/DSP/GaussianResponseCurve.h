@@ -1,9 +1,17 @@
 #pragma once
 
+#include "FastMath.h"
 #include "PluginParameters.h"
 #include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
 #include <vector>
 
 struct GaussianPeak {
@@ -11,41 +19,144 @@ struct GaussianPeak {
     float gainDB;
     float sigmaNorm;
 };
+// The peak list is immutable once published: every edit copies the current version, changes the
+// copy and swaps it in with one atomic store, RCU style. Readers take a PeakSnapshot, which never
+// locks or allocates, and a replaced version is only freed once no snapshot can still see it.
 class GaussianResponseCurve {
   public:
+    using PeakList = std::vector<GaussianPeak>;
+
+    // Notified on the thread that edited the peaks (normally the message thread), never for
+    // changes of the curve shift, which processors apply per frame.
+    struct Listener {
+        virtual ~Listener() = default;
+        virtual void responseCurveChanged() = 0;
+    };
+
+    // Pins the current version of the peak list for as long as it is alive.
+    class PeakSnapshot {
+      public:
+        explicit PeakSnapshot(const GaussianResponseCurve &curveToRead) : curve(curveToRead) {
+            curve.activeReaders.fetch_add(1);
+            peaks = curve.currentPeaks.load();
+        }
+
+        ~PeakSnapshot() { curve.activeReaders.fetch_sub(1); }
+
+        const PeakList &operator*() const { return *peaks; }
+        const PeakList *operator->() const { return peaks; }
+
+      private:
+        const GaussianResponseCurve &curve;
+        const PeakList *peaks;
+
+        JUCE_DECLARE_NON_COPYABLE(PeakSnapshot)
+    };
+
     GaussianResponseCurve() {
         // addPeak({100.0f, -40.0f, 0.25f});
         // addPeak({1000.0f, -60.0f, 0.075f});
         // addPeak({5000.0f, -80.0f, 0.025f});
     }
 
+    void addListener(Listener *listener) { listeners.add(listener); }
+    void removeListener(Listener *listener) { listeners.remove(listener); }
+
+    PeakSnapshot readPeaks() const { return PeakSnapshot(*this); }
+
+    // A copy of the current peaks, for callers that keep them across edits.
+    PeakList getGaussianPeaks() const { return *readPeaks(); }
+
     void addPeak(GaussianPeak newPeak) {
-        const std::lock_guard<std::mutex> lock(mutex);
-        gaussians.push_back(newPeak);
+        editPeaks([&](PeakList &peaks) {
+            peaks.push_back(newPeak);
+            return true;
+        });
     }
 
-    void deletePeak(size_t index) {
-        const std::lock_guard<std::mutex> lock(mutex);
-        if(index < gaussians.size())
-            gaussians.erase(gaussians.begin() + index);
+    void updatePeak(size_t index, GaussianPeak newPeak) {
+        editPeaks([&](PeakList &peaks) {
+            if(index >= peaks.size())
+                return false;
+            peaks[index] = newPeak;
+            return true;
+        });
     }
 
-    std::vector<GaussianPeak> &getGaussianPeaks() {
-        std::lock_guard<std::mutex> lock(mutex);
-        return gaussians;
+    void deletePeak(size_t index) {
+        editPeaks([&](PeakList &peaks) {
+            if(index >= peaks.size())
+                return false;
+            peaks.erase(peaks.begin() + (std::ptrdiff_t)index);
+            return true;
+        });
     }
 
+    // May be called from the audio thread (automation), so it is a plain atomic store.
     void setResponseCurveShiftDB(float newShiftDB) {
-        const std::lock_guard<std::mutex> lock(mutex);
-        responseCurveShiftDB = newShiftDB;
+        responseCurveShiftDB.store(newShiftDB, std::memory_order_relaxed);
+    }
+    float getResponseCurveShiftDB() const {
+        return responseCurveShiftDB.load(std::memory_order_relaxed);
+    }
+
+    // Sum of all peaks at every bin, given the ascending log10 frequencies of the bin centres
+    // (BinGeometry), excluding the curve shift. Returns false when there are no peaks.
+    bool compileThresholds(std::span<const float> logFrequencies,
+                           std::span<float> thresholdsDB) const {
+        const auto peaks = readPeaks();
+        std::fill(thresholdsDB.begin(), thresholdsDB.end(), 0.0f);
+        accumulatePeaks(*peaks, logFrequencies, thresholdsDB);
+
+        return !peaks->empty();
+    }
+
+    // A peak is only evaluated within this many sigmas of its centre. Beyond that it has fallen
+    // to exp(-12.5) = 3.7e-6 of its gain, under 0.0004 dB even for a 100 dB peak.
+    static constexpr float TRUNCATION_SIGMAS = 5.0f;
+
+    // The points [first, last) of the ascending log10 frequencies within TRUNCATION_SIGMAS of
+    // the peak's centre, found by bisection. Empty for a peak of zero width.
+    static std::pair<size_t, size_t> getCoveredRange(const GaussianPeak &peak,
+                                                     std::span<const float> logFrequencies) {
+        if(!(peak.sigmaNorm > 0.0f))
+            return {0, 0};
+
+        const float centre = std::log10(peak.frequency);
+        const float reach = TRUNCATION_SIGMAS * peak.sigmaNorm;
+        const auto first
+         = std::lower_bound(logFrequencies.begin(), logFrequencies.end(), centre - reach);
+        const auto last = std::upper_bound(first, logFrequencies.end(), centre + reach);
+        return {(size_t)(first - logFrequencies.begin()), (size_t)(last - logFrequencies.begin())};
+    }
+
+    // Adds the peaks' sum at each of the ascending log10 frequencies to sumsDB, for the
+    // thresholds and the curve display alike. Each peak only visits its covered range, so the
+    // cost follows the points the peaks cover instead of points times peaks.
+    static void accumulatePeaks(std::span<const GaussianPeak> peaks,
+                                std::span<const float> logFrequencies, std::span<float> sumsDB) {
+        jassert(logFrequencies.size() == sumsDB.size());
+        constexpr float LOG2_E = 1.44269504f;
+
+        for(const auto &peak : peaks) {
+            const auto [first, last] = getCoveredRange(peak, logFrequencies);
+            const float centre = std::log10(peak.frequency);
+
+            // exp(-d^2 / (2 sigma^2)) as 2^(d^2 * exponentScale), which vectorises
+            const float exponentScale = -0.5f * LOG2_E / (peak.sigmaNorm * peak.sigmaNorm);
+            const float gainDB = peak.gainDB;
+            for(size_t i = first; i < last; ++i) {
+                const float delta = logFrequencies[i] - centre;
+                sumsDB[i] += gainDB * FastMath::exp2(delta * delta * exponentScale);
+            }
+        }
     }
-    float getResponseCurveShiftDB() const { return responseCurveShiftDB; }
 
     ValueTree toValueTree() const {
         ValueTree tree("GaussianResponse");
 
         ValueTree peaksTree("Peaks");
-        for(const auto &peak : gaussians) {
+        for(const auto &peak : *readPeaks()) {
             ValueTree peakNode("Peak");
             peakNode.setProperty("frequency", peak.frequency, nullptr);
             peakNode.setProperty("gainDB", peak.gainDB, nullptr);
@@ -58,23 +169,55 @@ class GaussianResponseCurve {
     }
 
     void fromValueTree(const ValueTree &tree) {
-        const std::lock_guard<std::mutex> lock(mutex);
-        gaussians.clear();
-
-        if(auto peaksTree = tree.getChildWithName("Peaks"); peaksTree.isValid()) {
-            for(int i = 0; i < peaksTree.getNumChildren(); ++i) {
-                auto peakNode = peaksTree.getChild(i);
-                GaussianPeak peak;
-                peak.frequency = (float)peakNode.getProperty("frequency", 1000.0f);
-                peak.gainDB = (float)peakNode.getProperty("gainDB", 0.0f);
-                peak.sigmaNorm = (float)peakNode.getProperty("sigmaNorm", 0.25f);
-                gaussians.push_back(peak);
+        editPeaks([&](PeakList &peaks) {
+            peaks.clear();
+
+            if(auto peaksTree = tree.getChildWithName("Peaks"); peaksTree.isValid()) {
+                for(int i = 0; i < peaksTree.getNumChildren(); ++i) {
+                    auto peakNode = peaksTree.getChild(i);
+                    GaussianPeak peak;
+                    peak.frequency = (float)peakNode.getProperty("frequency", 1000.0f);
+                    peak.gainDB = (float)peakNode.getProperty("gainDB", 0.0f);
+                    peak.sigmaNorm = (float)peakNode.getProperty("sigmaNorm", 0.25f);
+                    peaks.push_back(peak);
+                }
             }
-        }
+            return true;
+        });
     }
 
   private:
-    float responseCurveShiftDB = Parameters::defaultCurveShiftDB;
-    mutable std::mutex mutex;
-    std::vector<GaussianPeak> gaussians;
+    // Builds the next version from a copy of the current one; edit returns false to discard it.
+    // Writers are serialised, and retired versions are reclaimed here, on the editing thread.
+    template <typename EditFunction> void editPeaks(EditFunction &&edit) {
+        {
+            const std::lock_guard<std::mutex> lock(writerMutex);
+            auto next = std::make_unique<PeakList>(*current);
+            if(!edit(*next))
+                return;
+
+            currentPeaks.store(next.get());
+            retired.push_back(std::move(current));
+            current = std::move(next);
+
+            // A snapshot taken from here on can only see the new version
+            if(activeReaders.load() == 0)
+                retired.clear();
+        }
+        notifyListeners();
+    }
+
+    void notifyListeners() {
+        listeners.call([](Listener &listener) { listener.responseCurveChanged(); });
+    }
+
+    std::atomic<float> responseCurveShiftDB{Parameters::defaultCurveShiftDB};
+
+    std::unique_ptr<const PeakList> current = std::make_unique<const PeakList>();
+    std::atomic<const PeakList *> currentPeaks{current.get()};
+    mutable std::atomic<int> activeReaders{0};
+    std::vector<std::unique_ptr<const PeakList>> retired;
+    std::mutex writerMutex;
+
+    juce::ListenerList<Listener> listeners;
 };
@@ -0,0 +1,302 @@
+#pragma once
+#include "GaussianResponseCurve.h"
+#include "PluginParameters.h"
+#include "SpectralCompressor.h"
+#include "WorkerPool.h"
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Owns one SpectralDynamicsProcessor per entry of Parameters::FFT_SIZES. All engines are allocated
+// up front, so changing resolution never allocates on the audio thread: the incoming engine is run
+// alongside the outgoing one until its overlap-add has settled, then the output fades out of the
+// outgoing engine and into the incoming one and the latency reported by getLatencySamples()
+// switches over. The engines' latencies differ, so the fade passes through silence rather than
+// mixing two copies of the signal a few milliseconds apart.
+//
+// An engine that was switched away from is reset on the message thread before it can be switched
+// to again, which keeps clearing its buffers off the audio thread.
+//
+// The engines are instantiated for the smallest of CHANNEL_CAPACITIES that holds the bus, so a
+// multichannel bed runs in one set of engines whose state is sized to it.
+class MultiResolutionProcessor : private juce::AsyncUpdater {
+  public:
+    static constexpr size_t NUM_RESOLUTIONS = Parameters::FFT_SIZES.size();
+    static constexpr int MAX_THREADS = 8;
+    // Mono runs in the stereo engines; 3 is LCR, 6 is 5.1 and 8 is 7.1
+    static constexpr std::array<int, 4> CHANNEL_CAPACITIES = {2, 3, 6, 8};
+
+    MultiResolutionProcessor(GaussianResponseCurve &responseCurveReference)
+        : responseCurve(responseCurveReference),
+          engines(createEngines(responseCurve, CHANNEL_CAPACITIES[0])),
+          channelCapacity(CHANNEL_CAPACITIES[0]) {
+        latencySamples.store(engines[activeIndex.load()]->getLatencySamples());
+    }
+
+    // While processing is stopped, on whichever thread the host prepares on. Rebuilds the engines
+    // only when the bus needs a different channel capacity: the new set is built and prepared
+    // first, then swapped in under the lock the displays read the active engine with.
+    void prepareToPlay(double newSampleRate, int maximumBlockSize, size_t overlapFactor,
+                       int numChannels, const ChannelGroups &layoutGroups) {
+        const int capacity = getChannelCapacity(numChannels);
+        const bool rebuild = capacity != channelCapacity;
+        EngineArray newEngines;
+        if(rebuild) {
+            newEngines = createEngines(responseCurve, capacity);
+            for(auto &engine : newEngines) {
+                engine->setWorkerPool(workerPool.get());
+                engine->setParameterSource(parameterSource);
+            }
+        }
+
+        for(auto &engine : rebuild ? newEngines : engines) {
+            engine->setLayoutGroups(layoutGroups);
+            engine->prepareToPlay(newSampleRate, overlapFactor);
+        }
+
+        incomingBuffer.setSize(juce::jmax(1, numChannels), juce::jmax(1, maximumBlockSize));
+        crossfadeLength = juce::jmax(1, (int)(newSampleRate * CROSSFADE_SECONDS));
+        sampleRate = newSampleRate;
+
+        {
+            const std::lock_guard<std::mutex> lock(engineMutex);
+            if(rebuild) {
+                for(auto &engine : newEngines)
+                    engine->setAnalysisEnabled(analysisSubscribers > 0);
+                std::swap(engines, newEngines);
+                channelCapacity = capacity;
+            }
+
+            activeIndex.store(requestedIndex.load());
+            incomingIndex = activeIndex.load();
+            // Preparing reset every engine
+            for(auto &flag : needsReset)
+                flag.store(false, std::memory_order_relaxed);
+            latencySamples.store(engines[activeIndex.load()]->getLatencySamples());
+        }
+        // The replaced engines, if any, are destroyed here, outside the lock
+    }
+
+    void processBlock(juce::AudioBuffer<float> &buffer) {
+        const size_t active = activeIndex.load(std::memory_order_relaxed);
+
+        // A request for an engine that still awaits its reset starts once the reset is done
+        if(!isSwitching()) {
+            const size_t requested = requestedIndex.load(std::memory_order_relaxed);
+            if(requested != active && !needsReset[requested].load(std::memory_order_acquire))
+                beginSwitch(requested);
+        }
+
+        if(!isSwitching()) {
+            engines[active]->processBlock(buffer);
+            return;
+        }
+
+        // Run in chunks that fit the preallocated buffer for the incoming engine
+        const int numSamples = buffer.getNumSamples();
+        const int chunkSize = incomingBuffer.getNumSamples();
+        for(int start = 0; start < numSamples; start += chunkSize) {
+            juce::AudioBuffer<float> chunk(buffer.getArrayOfWritePointers(),
+                                           buffer.getNumChannels(), start,
+                                           juce::jmin(chunkSize, numSamples - start));
+            processSwitchingChunk(chunk);
+        }
+    }
+
+    // Thread-safe; takes effect at the start of the next block once any running switch is done.
+    void setResolution(size_t index) {
+        requestedIndex.store(juce::jlimit<size_t>(0, NUM_RESOLUTIONS - 1, index));
+    }
+
+    // Message thread. Calls reader(SpectralEngine &) with the active engine, which prepareToPlay
+    // cannot replace meanwhile, and returns what it returns.
+    template <typename READER> decltype(auto) readActiveEngine(READER &&reader) {
+        const std::lock_guard<std::mutex> lock(engineMutex);
+        return reader(*engines[activeIndex.load()]);
+    }
+
+    // Any thread; follows the active engine once a resolution switch completes.
+    int getLatencySamples() const { return latencySamples.load(std::memory_order_relaxed); }
+    double getSampleRate() const { return sampleRate; }
+
+    // Message thread, while processing is stopped. With more than one thread the engines share
+    // their per-channel frames (and the bins of the largest frames) with a pool of workers,
+    // which block between hops and so only suit offline rendering.
+    void setNumThreads(int numThreads) {
+        numThreads = juce::jlimit(1, MAX_THREADS, numThreads);
+        if(numThreads == (workerPool != nullptr ? workerPool->getConcurrency() : 1))
+            return;
+
+        for(auto &engine : engines)
+            engine->setWorkerPool(nullptr);
+
+        workerPool.reset();
+        if(numThreads > 1)
+            workerPool = std::make_unique<WorkerPool>(numThreads - 1);
+
+        for(auto &engine : engines)
+            engine->setWorkerPool(workerPool.get());
+    }
+
+    void setParameterSource(const DynamicsParameterSource &source) {
+        parameterSource = source;
+        for(auto &engine : engines)
+            engine->setParameterSource(source);
+    }
+
+    // Message thread.
+    CompressorMode getCompressorMode() const {
+        const std::lock_guard<std::mutex> lock(engineMutex);
+        return engines[activeIndex.load()]->getCompressorMode();
+    }
+
+    // Held by every analysis display; the engines only compute and publish spectra while at least
+    // one subscription is alive, so instances with a closed editor skip the analysis entirely.
+    class AnalysisSubscription {
+      public:
+        explicit AnalysisSubscription(MultiResolutionProcessor &processorToWatch)
+            : owner(processorToWatch) {
+            owner.updateAnalysisSubscribers(+1);
+        }
+
+        ~AnalysisSubscription() { owner.updateAnalysisSubscribers(-1); }
+
+      private:
+        MultiResolutionProcessor &owner;
+
+        JUCE_DECLARE_NON_COPYABLE(AnalysisSubscription)
+    };
+
+  private:
+    static constexpr double CROSSFADE_SECONDS = 0.02;
+
+    using EngineArray = std::array<std::unique_ptr<SpectralEngine>, NUM_RESOLUTIONS>;
+
+    static int getChannelCapacity(int numChannels) {
+        for(const int capacity : CHANNEL_CAPACITIES)
+            if(numChannels <= capacity)
+                return capacity;
+
+        jassertfalse; // the plugin should not have accepted this layout
+        return CHANNEL_CAPACITIES.back();
+    }
+
+    static EngineArray createEngines(GaussianResponseCurve &curve, int capacity) {
+        constexpr auto resolutions = std::make_index_sequence<NUM_RESOLUTIONS>();
+        switch(capacity) {
+        case 3: return createEngines<3>(curve, resolutions);
+        case 6: return createEngines<6>(curve, resolutions);
+        case 8: return createEngines<8>(curve, resolutions);
+        default: return createEngines<2>(curve, resolutions);
+        }
+    }
+
+    template <size_t NUM_CHANNELS, size_t... I>
+    static EngineArray createEngines(GaussianResponseCurve &curve, std::index_sequence<I...>) {
+        return {std::make_unique<
+         SpectralDynamicsProcessor<Parameters::FFT_SIZES[I], NUM_CHANNELS>>(curve)...};
+    }
+
+    // Message thread only.
+    void updateAnalysisSubscribers(int delta) {
+        const std::lock_guard<std::mutex> lock(engineMutex);
+        analysisSubscribers += delta;
+        jassert(analysisSubscribers >= 0);
+
+        for(auto &engine : engines)
+            engine->setAnalysisEnabled(analysisSubscribers > 0);
+    }
+
+    bool isSwitching() const { return incomingIndex != activeIndex.load(std::memory_order_relaxed); }
+
+    // Message thread. Clears the engines the audio thread has switched away from.
+    void handleAsyncUpdate() override {
+        const std::lock_guard<std::mutex> lock(engineMutex);
+        for(size_t index = 0; index < NUM_RESOLUTIONS; ++index) {
+            if(needsReset[index].load(std::memory_order_acquire)) {
+                engines[index]->reset();
+                needsReset[index].store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    // The incoming engine is idle and was reset since it last ran.
+    void beginSwitch(size_t newIndex) {
+        incomingIndex = newIndex;
+        switchPosition = 0;
+
+        // A freshly reset engine only produces fully overlapped output once every frame covering
+        // a sample was computed from real input, i.e. one frame plus one frame of latency. The
+        // outgoing engine fades out just before that, so its fade must fit in front of it.
+        const int fftSize = (int)engines[newIndex]->getFFTSize();
+        crossfadeStart = juce::jmax(2 * fftSize, crossfadeLength);
+    }
+
+    void processSwitchingChunk(juce::AudioBuffer<float> &chunk) {
+        const int numSamples = chunk.getNumSamples();
+        const int numChannels = juce::jmin(chunk.getNumChannels(), incomingBuffer.getNumChannels());
+
+        juce::AudioBuffer<float> incomingChunk(incomingBuffer.getArrayOfWritePointers(), numChannels,
+                                               numSamples);
+        for(int ch = 0; ch < numChannels; ++ch)
+            incomingChunk.copyFrom(ch, 0, chunk, ch, 0, numSamples);
+
+        engines[activeIndex.load(std::memory_order_relaxed)]->processBlock(chunk);
+        engines[incomingIndex]->processBlock(incomingChunk);
+
+        for(int ch = 0; ch < numChannels; ++ch) {
+            auto *out = chunk.getWritePointer(ch);
+            const auto *in = incomingChunk.getReadPointer(ch);
+
+            // Out of the outgoing engine before crossfadeStart, into the incoming one after it
+            for(int i = 0; i < numSamples; ++i) {
+                const float position
+                 = (float)(switchPosition + i - crossfadeStart) / (float)crossfadeLength;
+                const float fadeOut = juce::jlimit(0.0f, 1.0f, -position);
+                const float fadeIn = juce::jlimit(0.0f, 1.0f, position);
+                out[i] = fadeOut * out[i] + fadeIn * in[i];
+            }
+        }
+
+        switchPosition += numSamples;
+        if(switchPosition >= crossfadeStart + crossfadeLength) {
+            const size_t outgoing = activeIndex.load(std::memory_order_relaxed);
+            activeIndex.store(incomingIndex);
+            latencySamples.store(engines[incomingIndex]->getLatencySamples(),
+                                 std::memory_order_relaxed);
+
+            needsReset[outgoing].store(true, std::memory_order_release);
+            triggerAsyncUpdate();
+        }
+    }
+
+    GaussianResponseCurve &responseCurve;
+    // Replaced only by prepareToPlay, under engineMutex; the audio thread reads it without the
+    // lock, as processing is stopped while it changes
+    EngineArray engines;
+    mutable std::mutex engineMutex;
+    int channelCapacity;
+    std::unique_ptr<WorkerPool> workerPool;
+    DynamicsParameterSource parameterSource;
+
+    std::atomic<size_t> requestedIndex{(size_t)Parameters::defaultResolutionIndex};
+    std::atomic<size_t> activeIndex{(size_t)Parameters::defaultResolutionIndex};
+    size_t incomingIndex = (size_t)Parameters::defaultResolutionIndex;
+    // Set by the audio thread for an engine it switched away from, cleared once it was reset
+    std::array<std::atomic<bool>, NUM_RESOLUTIONS> needsReset{};
+    std::atomic<int> latencySamples{0};
+
+    juce::AudioBuffer<float> incomingBuffer;
+    int switchPosition = 0;
+    int crossfadeStart = 0;
+    int crossfadeLength = 1;
+
+    double sampleRate = 44100.0;
+    int analysisSubscribers = 0; // guarded by engineMutex
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiResolutionProcessor)
+};
@@ -0,0 +1,51 @@
+#include "SpectralCompressor.h"
+
+template class FFTProcessor<512>;
+template class FFTProcessor<1024>;
+template class FFTProcessor<2048>;
+template class FFTProcessor<4096>;
+template class FFTProcessor<8192>;
+template class FFTProcessor<16384>;
+template class FFTProcessor<512, 3>;
+template class FFTProcessor<1024, 3>;
+template class FFTProcessor<2048, 3>;
+template class FFTProcessor<4096, 3>;
+template class FFTProcessor<8192, 3>;
+template class FFTProcessor<16384, 3>;
+template class FFTProcessor<512, 6>;
+template class FFTProcessor<1024, 6>;
+template class FFTProcessor<2048, 6>;
+template class FFTProcessor<4096, 6>;
+template class FFTProcessor<8192, 6>;
+template class FFTProcessor<16384, 6>;
+template class FFTProcessor<512, 8>;
+template class FFTProcessor<1024, 8>;
+template class FFTProcessor<2048, 8>;
+template class FFTProcessor<4096, 8>;
+template class FFTProcessor<8192, 8>;
+template class FFTProcessor<16384, 8>;
+
+template class SpectralDynamicsProcessor<512>;
+template class SpectralDynamicsProcessor<1024>;
+template class SpectralDynamicsProcessor<2048>;
+template class SpectralDynamicsProcessor<4096>;
+template class SpectralDynamicsProcessor<8192>;
+template class SpectralDynamicsProcessor<16384>;
+template class SpectralDynamicsProcessor<512, 3>;
+template class SpectralDynamicsProcessor<1024, 3>;
+template class SpectralDynamicsProcessor<2048, 3>;
+template class SpectralDynamicsProcessor<4096, 3>;
+template class SpectralDynamicsProcessor<8192, 3>;
+template class SpectralDynamicsProcessor<16384, 3>;
+template class SpectralDynamicsProcessor<512, 6>;
+template class SpectralDynamicsProcessor<1024, 6>;
+template class SpectralDynamicsProcessor<2048, 6>;
+template class SpectralDynamicsProcessor<4096, 6>;
+template class SpectralDynamicsProcessor<8192, 6>;
+template class SpectralDynamicsProcessor<16384, 6>;
+template class SpectralDynamicsProcessor<512, 8>;
+template class SpectralDynamicsProcessor<1024, 8>;
+template class SpectralDynamicsProcessor<2048, 8>;
+template class SpectralDynamicsProcessor<4096, 8>;
+template class SpectralDynamicsProcessor<8192, 8>;
+template class SpectralDynamicsProcessor<16384, 8>;
@@ -1,228 +1,861 @@
 #pragma once
+#include "BandLayout.h"
 #include "FFTProcessor.h"
+#include "FastMath.h"
 #include "GaussianResponseCurve.h"
 #include "juce_audio_basics/juce_audio_basics.h"
 #include <JuceHeader.h>
 #include <array>
+#include <atomic>
 #include <cstddef>
+#include <mutex>
 #include <vector>
 #include <cmath>
 
-enum CompressorMode { COMPRESSOR, EXPANDER, CLIPPER, GATE };
-
 template <size_t FFT_SIZE = 512, size_t NUM_CHANNELS = 2>
-class SpectralDynamicsProcessor : public FFTProcessor<FFT_SIZE, NUM_CHANNELS> {
+class SpectralDynamicsProcessor : public FFTProcessor<FFT_SIZE, NUM_CHANNELS>,
+                                  private GaussianResponseCurve::Listener {
   public:
     SpectralDynamicsProcessor(GaussianResponseCurve &responseCurveReference)
         : FFTProcessor<FFT_SIZE, NUM_CHANNELS>(), responseCurve(responseCurveReference) {
-        envelopeFollowers.fill(0.0f);
+        responseCurve.addListener(this);
+        hopThresholds = &thresholdTables.read();
+        for(size_t ch = 0; ch < NUM_CHANNELS; ++ch)
+            detectorChannels[ch] = (int)ch;
     }
 
-    void setCompressorMode(CompressorMode newMode) { mode = newMode; }
-
-    std::array<float, FFT_SIZE / 2 + 1> getGainReductionArray() const { return gainReductionArray; }
+    ~SpectralDynamicsProcessor() override { responseCurve.removeListener(this); }
 
-    void setAttackTime(float timeMs) {
-        attackTimeMs = timeMs;
-        updateCoefficients();
+    void setParameterSource(const DynamicsParameterSource &source) override {
+        parameterSource = source;
     }
 
-    void setReleaseTime(float timeMs) {
-        releaseTimeMs = timeMs;
-        updateCoefficients();
+    void setLayoutGroups(const ChannelGroups &newLayoutGroups) override {
+        layoutGroups = newLayoutGroups;
+        applyChannelLink(link);
     }
 
-    void setRatio(float newRatio) { ratio = newRatio; }
-
-    void setKnee(float kneeDB) { kneeWidthDB = kneeDB; }
-
-    void prepareToPlay(double newSampleRate) override {
-        FFTProcessor<FFT_SIZE, NUM_CHANNELS>::prepareToPlay(newSampleRate);
-        this->nyquist = static_cast<float>(newSampleRate) * 0.5f;
+    void prepareToPlay(double newSampleRate, size_t overlapFactor) override {
+        // Every band scale is laid out up front, so switching scales never allocates. The layouts
+        // are built first and published with the bin geometry under the lock rebuildThresholds
+        // takes on the message thread, which reads both.
+        const auto newBinGeometry = BinGeometry::get(newSampleRate, FFT_SIZE);
+        decltype(bandLayouts) newBandLayouts;
+        for(size_t bandScale = PER_BIN + 1; bandScale < NUM_DETECTION_SCALES; ++bandScale)
+            newBandLayouts[bandScale] = BandLayout::get(*newBinGeometry, (DetectionScale)bandScale);
+
+        {
+            const std::lock_guard<std::mutex> lock(thresholdBuildMutex);
+            FFTProcessor<FFT_SIZE, NUM_CHANNELS>::prepareToPlay(newSampleRate, overlapFactor);
+            bandLayouts = std::move(newBandLayouts);
+        }
+        bands = bandLayouts[detection].get();
 
         // Use the parent class's computed window gain
         this->scale = (2.0f / FFT_SIZE) / this->windowCoherentGain;
         this->dcNyquistScale = (1.0f / FFT_SIZE) / this->windowCoherentGain;
 
-        updateCoefficients();
-        envelopeFollowers.fill(0.0f);
+        // Resetting a ramp also jumps it to the value latched just before
+        latchParameters();
+        for(auto *smoothed : {&ratio, &kneeWidthDB, &attackTimeMs, &releaseTimeMs})
+            smoothed->reset(newSampleRate, PARAMETER_SMOOTHING_SECONDS);
+        blockLength = 0;
+        rampPosition = 0;
+
+        updateCurve(kneeWidthDB.getCurrentValue(), ratio.getCurrentValue());
+        updateTimeScales();
+        updateCoefficients(attackTimeMs.getCurrentValue(), releaseTimeMs.getCurrentValue());
+        rebuildThresholds();
+    }
+
+    void reset() override {
+        FFTProcessor<FFT_SIZE, NUM_CHANNELS>::reset();
+        for(auto &state : channelStates) {
+            state.envelopeFollowers.fill(0.0f);
+            state.slowEnvelopes.fill(0.0f);
+            state.bandEnvelopes.fill(0.0f);
+            state.bandSlowEnvelopes.fill(0.0f);
+            state.skippedFrames = 0;
+        }
     }
 
-    CompressorMode getCompressorMode() const { return mode; }
+    CompressorMode getCompressorMode() const override {
+        return latchedMode.load(std::memory_order_relaxed);
+    }
 
   private:
+    // Drive the kernels below directly: the test checks them against a scalar reference, the
+    // benchmark times them against the per-bin code they replaced
+    friend class SpectralDynamicsAccuracyTest;
+    friend class SpectralDynamicsBenchmark;
+
+    using ChannelGroup = typename FFTProcessor<FFT_SIZE, NUM_CHANNELS>::ChannelGroup;
+
     static constexpr size_t NUM_BINS = FFT_SIZE / 2 + 1;
-    static constexpr size_t OVERLAP_FACTOR = 4;
-    static constexpr float MIN_MAGNITUDE_THRESHOLD = 1e-10f;
+    static constexpr size_t MAX_BANDS = BandLayout::MAX_BANDS;
+    static constexpr float MIN_POWER = 1e-20f; // magnitude 1e-10
     static constexpr float MIN_MAGNITUDE_DB = -100.0f;
+    static constexpr float GATE_REDUCTION_DB = 100.0f; // practically mute
+    static constexpr float DB_PER_LOG2_POWER = 3.01029996f; // 10 * log10(2)
+    static constexpr float LOG2_GAIN_PER_DB = 0.166096404f; // log2(10) / 20
+    static constexpr float LOG2_E = 1.44269504f;
+    static constexpr float LOG2_10 = 3.32192809f;
     static constexpr float MAX_COEFF = 0.99999f;
-
-    void updateCoefficients() {
-        if(this->sampleRate <= 0.0)
+    // Per-sample ramp for ratio, knee and times, so automation sweeps do not step per block
+    static constexpr double PARAMETER_SMOOTHING_SECONDS = 0.05;
+    // The attack and release knobs set the times at this frequency; the tilt scales them per
+    // octave away from it
+    static constexpr float TIME_TILT_PIVOT_HZ = 1000.0f;
+    // Auto release: the reduction history follows the target this many release times slowly
+    static constexpr float AUTO_RELEASE_SLOW_FACTOR = 5.0f;
+
+    // The response curve sampled at this engine's bin centres, without the curve shift, and
+    // averaged over the bands of every band scale
+    struct ThresholdTable {
+        std::array<float, NUM_BINS> thresholdsDB;
+        std::array<std::array<float, MAX_BANDS>, NUM_DETECTION_SCALES> bandThresholdsDB;
+        bool hasPeaks = false;
+    };
+
+    // Per-element envelope coefficients of one gain computer pass, over the bins or the bands
+    struct EnvelopeCoefficients {
+        const float *attack;
+        const float *release;
+        const float *slow; // of the auto-release history
+    };
+
+    // Everything the kernel keeps for one channel: the envelopes and the per-frame scratch of
+    // the kernel stages. In a linked group, the first channel's state holds the group's shared
+    // detector (linkedLevelsDB onwards); the others only contribute their levels. Every array
+    // starts a cache line, so workers on different channels or bin ranges never share one.
+    struct ChannelState {
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> envelopeFollowers{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> slowEnvelopes{}; // auto release
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> powers{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> levelsDB{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> linkedLevelsDB{}; // group's loudest
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> gainReductionsDB{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> gains{};
+        // The same per band while a band scale is detected; the bin gains are interpolated
+        alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandEnvelopes{};
+        alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandSlowEnvelopes{};
+        alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandLevelsDB{};
+        alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> linkedBandLevelsDB{};
+        alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandGainReductionsDB{};
+        alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandGains{};
+        // The coefficients of the skipped frames, over the bins or the bands (settleEnvelopes)
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> settleAttackCoeffs{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> settleReleaseCoeffs{};
+        alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> settleSlowCoeffs{};
+        int skippedFrames = 0; // silent frames not yet applied to the envelopes
+    };
+
+    void responseCurveChanged() override { rebuildThresholds(); }
+
+    // Runs off the audio thread, whenever the peaks or the sample rate change. Until the first
+    // prepareToPlay there is no sample rate to place the bins at, and it rebuilds them anyway.
+    void rebuildThresholds() {
+        const std::lock_guard<std::mutex> lock(thresholdBuildMutex);
+        if(this->binGeometry == nullptr)
             return;
 
-        const float hopSize = FFT_SIZE / static_cast<float>(OVERLAP_FACTOR);
-        const float timePerHop = hopSize / static_cast<float>(this->sampleRate);
+        auto &table = thresholdTables.write();
+        table.hasPeaks
+         = responseCurve.compileThresholds(this->binGeometry->logFrequencies, table.thresholdsDB);
+        for(size_t bandScale = PER_BIN + 1; bandScale < NUM_DETECTION_SCALES; ++bandScale)
+            bandLayouts[bandScale]->averageBins(table.thresholdsDB.data(),
+                                                table.bandThresholdsDB[bandScale].data());
+        thresholdTables.publish();
+    }
+
+    // The host delivers one parameter value per block, valid from its first sample. The ramps
+    // run per sample from there and are evaluated at each hop's exact position in the block, so
+    // a hop sees the same settings however the host splits the signal into blocks.
+    void beginBlock(int numSamples) override {
+        advanceRamps(blockLength - rampPosition);
+        latchParameters();
+        blockLength = numSamples;
+        rampPosition = 0;
+    }
+
+    void beginHop(int samplePosition) override {
+        advanceRamps(samplePosition - rampPosition);
+        rampPosition = samplePosition;
+
+        // Every frame and bin range of this hop sees the same table and shift
+        hopThresholds = &thresholdTables.read();
+        hopShiftDB = responseCurve.getResponseCurveShiftDB();
 
-        attackCoeff = std::exp(-timePerHop / (attackTimeMs * 0.001f));
-        releaseCoeff = std::exp(-timePerHop / (releaseTimeMs * 0.001f));
+        updateCurve(kneeWidthDB.getCurrentValue(), ratio.getCurrentValue());
 
-        attackCoeff = juce::jlimit(0.0f, MAX_COEFF, attackCoeff);
-        releaseCoeff = juce::jlimit(0.0f, MAX_COEFF, releaseCoeff);
+        // Only pay for the exponentials while a time is actually moving
+        const float attackMs = attackTimeMs.getCurrentValue();
+        const float releaseMs = releaseTimeMs.getCurrentValue();
+        if(attackMs != coefficientsAttackMs || releaseMs != coefficientsReleaseMs)
+            updateCoefficients(attackMs, releaseMs);
     }
 
-    void processFFTBins(std::array<float, FFT_SIZE * 2> &transformedBuffer) override {
-        const auto gaussianPeaks = responseCurve.getGaussianPeaks();
-        if(gaussianPeaks.empty())
+    // Constant time per call whatever the distance, and free once a ramp has arrived
+    void advanceRamps(int numSamples) {
+        if(numSamples <= 0)
             return;
 
-        for(size_t bin = 0; bin < NUM_BINS; ++bin) {
-            processSingleBin(transformedBuffer, bin, gaussianPeaks);
+        for(auto *smoothed : {&ratio, &kneeWidthDB, &attackTimeMs, &releaseTimeMs})
+            if(smoothed->isSmoothing())
+                smoothed->skip(numSamples);
+    }
+
+    // Reads the current parameter values into the mode and the ramp targets.
+    void latchParameters() {
+        const auto &source = parameterSource;
+        if(source.compressorMode != nullptr) {
+            const auto index
+             = static_cast<int>(source.compressorMode->load(std::memory_order_relaxed));
+            mode = static_cast<CompressorMode>(juce::jlimit((int)COMPRESSOR, (int)GATE, index));
+            latchedMode.store(mode, std::memory_order_relaxed);
+        }
+
+        auto follow = [](juce::SmoothedValue<float> &smoothed, const std::atomic<float> *value) {
+            if(value != nullptr)
+                smoothed.setTargetValue(value->load(std::memory_order_relaxed));
+        };
+        follow(ratio, source.ratio);
+        follow(kneeWidthDB, source.kneeDB);
+        follow(attackTimeMs, source.attackTimeMs);
+        follow(releaseTimeMs, source.releaseTimeMs);
+
+        if(source.channelLink != nullptr) {
+            const auto index
+             = static_cast<int>(source.channelLink->load(std::memory_order_relaxed));
+            const auto newLink
+             = static_cast<ChannelLink>(juce::jlimit((int)UNLINKED, (int)LINK_ALL, index));
+            if(newLink != link)
+                applyChannelLink(newLink);
+        }
+
+        if(source.detectionScale != nullptr) {
+            const auto index
+             = static_cast<int>(source.detectionScale->load(std::memory_order_relaxed));
+            const auto newScale = static_cast<DetectionScale>(
+             juce::jlimit((int)PER_BIN, (int)NUM_DETECTION_SCALES - 1, index));
+            if(newScale != detection)
+                applyDetectionScale(newScale);
+        }
+
+        // Only the compressor releases automatically; the history starts empty whenever it
+        // comes into use, rather than from whatever it last held
+        const bool newAutoRelease = source.autoRelease != nullptr
+                                    && source.autoRelease->load(std::memory_order_relaxed) >= 0.5f
+                                    && mode == COMPRESSOR;
+        if(newAutoRelease && !autoRelease) {
+            for(auto &state : channelStates) {
+                state.slowEnvelopes.fill(0.0f);
+                state.bandSlowEnvelopes.fill(0.0f);
+            }
+        }
+        autoRelease = newAutoRelease;
+
+        if(source.timeTilt != nullptr) {
+            const float newTilt = source.timeTilt->load(std::memory_order_relaxed);
+            if(newTilt != timeTilt) {
+                timeTilt = newTilt;
+                updateTimeScales();
+                updateCoefficients(coefficientsAttackMs, coefficientsReleaseMs);
+            }
         }
     }
 
-    void processSingleBin(std::array<float, FFT_SIZE * 2> &buffer, size_t bin,
-                          const std::vector<GaussianPeak> &gaussianPeaks) {
-        const float frequency = binToFrequency(bin);
-        float magnitude, phase;
-        extractMagnitudeAndPhase(buffer, bin, magnitude, phase);
-        const float magnitudeDB = magnitudeToDecibels(magnitude);
-        const float thresholdDB = calculateGaussianSum(frequency, gaussianPeaks);
-        const float gainReductionDB = calculateCompression(magnitudeDB, thresholdDB, bin);
-        gainReductionArray[bin] = gainReductionDB;
-        const float gainLinear = Decibels::decibelsToGain(-gainReductionDB);
-        magnitude *= gainLinear;
-        reconstructComplexValue(buffer, bin, magnitude, phase);
+    // Regroups the channels between frames. A channel that starts leading a group takes over the
+    // envelopes of the detector it followed so far, so changing the link does not make the gain
+    // reduction jump back to zero.
+    void applyChannelLink(ChannelLink newLink) {
+        link = newLink;
+
+        const int allChannels[] = {(int)NUM_CHANNELS};
+        std::span<const int> groupSizes;
+        if(link == LINK_ALL)
+            groupSizes = allChannels;
+        else if(link == LINK_GROUPS)
+            groupSizes = std::span(layoutGroups.sizes).first((size_t)layoutGroups.numGroups);
+        this->setProcessingGroups(groupSizes);
+
+        std::array<int, NUM_CHANNELS> newDetectorChannels;
+        int firstChannel = 0;
+        for(const int size : groupSizes) {
+            const int endChannel = juce::jmin(firstChannel + size, (int)NUM_CHANNELS);
+            for(int ch = firstChannel; ch < endChannel; ++ch)
+                newDetectorChannels[(size_t)ch] = firstChannel;
+            firstChannel = endChannel;
+        }
+        for(int ch = firstChannel; ch < (int)NUM_CHANNELS; ++ch)
+            newDetectorChannels[(size_t)ch] = ch;
+
+        for(size_t ch = 0; ch < NUM_CHANNELS; ++ch) {
+            const auto previous = (size_t)detectorChannels[ch];
+            if(newDetectorChannels[ch] == (int)ch && previous != ch) {
+                auto &state = channelStates[ch];
+                const auto &previousState = channelStates[previous];
+                state.envelopeFollowers = previousState.envelopeFollowers;
+                state.slowEnvelopes = previousState.slowEnvelopes;
+                state.bandEnvelopes = previousState.bandEnvelopes;
+                state.bandSlowEnvelopes = previousState.bandSlowEnvelopes;
+                state.skippedFrames = previousState.skippedFrames;
+            }
+        }
+        detectorChannels = newDetectorChannels;
     }
 
-    float binToFrequency(size_t bin) const {
-        return bin / static_cast<float>(FFT_SIZE) * this->sampleRate;
+    // Switches the detector between the bins and a band scale between frames. The envelopes
+    // carry over, interpolated from the old bands to the bins and averaged into the new ones, so
+    // the gain reduction does not jump back to zero.
+    void applyDetectionScale(DetectionScale newScale) {
+        const BandLayout *newBands = bandLayouts[newScale].get();
+        for(auto &state : channelStates) {
+            if(bands != nullptr) {
+                bands->interpolateBands(state.bandEnvelopes.data(),
+                                        state.envelopeFollowers.data(), 0, NUM_BINS);
+                bands->interpolateBands(state.bandSlowEnvelopes.data(),
+                                        state.slowEnvelopes.data(), 0, NUM_BINS);
+            }
+            if(newBands != nullptr) {
+                newBands->averageBins(state.envelopeFollowers.data(), state.bandEnvelopes.data());
+                newBands->averageBins(state.slowEnvelopes.data(), state.bandSlowEnvelopes.data());
+            }
+        }
+
+        detection = newScale;
+        bands = newBands;
+        updateCoefficients(coefficientsAttackMs, coefficientsReleaseMs);
     }
 
-    bool isDCOrNyquistBin(size_t bin) const { return bin == 0 || bin == FFT_SIZE / 2; }
+    void updateCurve(float kneeWidth, float curveRatio) {
+        hopKneeDB = kneeWidth;
+        hopSlope = 1.0f - 1.0f / curveRatio;
+    }
 
-    void extractMagnitudeAndPhase(const std::array<float, FFT_SIZE * 2> &buffer, size_t bin,
-                                  float &magnitude, float &phase) const {
-        if(isDCOrNyquistBin(bin)) {
-            magnitude = std::abs(buffer[bin]) * dcNyquistScale;
-            phase = (buffer[bin] >= 0.0f) ? 0.0f : juce::MathConstants<float>::pi;
-        } else {
-            const float real = buffer[2 * bin];
-            const float imag = buffer[2 * bin + 1];
-            magnitude = std::sqrt(real * real + imag * imag) * scale;
-            phase = std::atan2(imag, real);
+    void updateCoefficients(float attackMs, float releaseMs) {
+        coefficientsAttackMs = attackMs;
+        coefficientsReleaseMs = releaseMs;
+
+        if(this->sampleRate <= 0.0)
+            return;
+
+        // Envelopes advance once per hop
+        const float timePerHop
+         = static_cast<float>(this->getHopSize()) / static_cast<float>(this->sampleRate);
+
+        compileCoefficients(timePerHop / (coefficientsAttackMs * 0.001f), attackCoeffs,
+                            bandAttackCoeffs);
+        compileCoefficients(timePerHop / (coefficientsReleaseMs * 0.001f), releaseCoeffs,
+                            bandReleaseCoeffs);
+        compileCoefficients(
+         timePerHop / (coefficientsReleaseMs * 0.001f * AUTO_RELEASE_SLOW_FACTOR), slowCoeffs,
+         bandSlowCoeffs);
+    }
+
+    // exp(-hops / time constant) for every bin, the time constant scaled by the bin's tilt, and
+    // its mean over every band of the detected scale. A flat tilt takes the pivot's coefficient
+    // as is, so the bins see exactly the value a single coefficient would have.
+    void compileCoefficients(float hopsPerTimeConstant, std::array<float, NUM_BINS> &coeffs,
+                             std::array<float, MAX_BANDS> &bandCoeffs) const {
+        if(timeTilt == 1.0f) {
+            const float coeff = juce::jlimit(0.0f, MAX_COEFF, std::exp(-hopsPerTimeConstant));
+            coeffs.fill(coeff);
+            bandCoeffs.fill(coeff);
+            return;
+        }
+
+        const float log2Coeff = -hopsPerTimeConstant * LOG2_E;
+        for(size_t bin = 0; bin < NUM_BINS; ++bin)
+            coeffs[bin] = std::min(FastMath::exp2(log2Coeff * inverseTimeScales[bin]), MAX_COEFF);
+        if(bands != nullptr)
+            bands->averageBins(coeffs.data(), bandCoeffs.data());
+    }
+
+    // 1 / time scale of every bin: the times grow by timeTilt for every octave above
+    // TIME_TILT_PIVOT_HZ. Bins below MIN_DISPLAY_FREQUENCY count as sitting on it, which keeps
+    // DC finite.
+    void updateTimeScales() {
+        if(this->binGeometry == nullptr)
+            return;
+
+        const float log2Tilt = std::log2(timeTilt);
+        const float minLogFrequency = std::log10(BinGeometry::MIN_DISPLAY_FREQUENCY);
+        const float pivotLogFrequency = std::log10(TIME_TILT_PIVOT_HZ);
+        const auto &logFrequencies = this->binGeometry->logFrequencies;
+        for(size_t bin = 0; bin < NUM_BINS; ++bin) {
+            const float octaves
+             = (std::max(logFrequencies[bin], minLogFrequency) - pivotLogFrequency) * LOG2_10;
+            inverseTimeScales[bin] = std::exp2(-log2Tilt * octaves);
         }
     }
 
-    void reconstructComplexValue(std::array<float, FFT_SIZE * 2> &buffer, size_t bin,
-                                 float magnitude, float phase) const {
-        if(isDCOrNyquistBin(bin)) {
-            magnitude /= dcNyquistScale;
-            buffer[bin] = magnitude * std::cos(phase);
+    // Structure-of-arrays kernel: each stage is one straight loop over the bin range, with
+    // selects in place of branches and FastMath in place of libm, so the compiler vectorises
+    // every stage. Compared with the former per-bin scalar path the gain reduction differs by
+    // less than 1e-4 dB; see FastMath for the approximation bounds. All state is per channel
+    // group and per bin, so groups and disjoint bin ranges may run concurrently.
+    //
+    // A linked group detects on the loudest of its channels in every bin and applies the one
+    // resulting gain to all of them, which keeps the image of a pair or bed stable.
+    void processFFTBins(const ChannelGroup &group, bool analyse, size_t beginBin,
+                        size_t endBin) override {
+        const int endChannel = group.firstChannel + group.numChannels;
+        auto &detector = channelStates[(size_t)group.firstChannel];
+
+        if(!hopThresholds->hasPeaks) {
+            // Passthrough: the wet spectrum is the dry one
+            if(!analyse)
+                return;
+
+            for(int ch = group.firstChannel; ch < endChannel; ++ch) {
+                auto &analysis = this->getChannelAnalysis(ch);
+                this->computeMagnitudes(this->getFFTBuffer(ch), analysis.dryMagnitudes, beginBin,
+                                        endBin);
+                std::copy(analysis.dryMagnitudes.begin() + beginBin,
+                          analysis.dryMagnitudes.begin() + endBin,
+                          analysis.wetMagnitudes.begin() + beginBin);
+                std::fill(analysis.gainReductionsDB.begin() + beginBin,
+                          analysis.gainReductionsDB.begin() + endBin, 0.0f);
+            }
+            return;
+        }
+
+        if(bands != nullptr) {
+            // The bands were detected in beginFrame; only their gains are spread over the bins
+            bands->interpolateBands(detector.bandGains.data(), detector.gains.data(), beginBin,
+                                    endBin);
         } else {
-            magnitude /= scale;
-            buffer[2 * bin] = magnitude * std::cos(phase);
-            buffer[2 * bin + 1] = magnitude * std::sin(phase);
+            for(int ch = group.firstChannel; ch < endChannel; ++ch)
+                computeLevels(channelStates[(size_t)ch], this->getFFTBuffer(ch), beginBin,
+                              endBin);
+
+            const auto &detectorLevelsDB = linkLevels(group, &ChannelState::levelsDB,
+                                                      &ChannelState::linkedLevelsDB, beginBin,
+                                                      endBin);
+            computeGainReduction(detectorLevelsDB, hopThresholds->thresholdsDB,
+                                 detector.envelopeFollowers, detector.slowEnvelopes,
+                                 detector.gainReductionsDB,
+                                 {attackCoeffs.data(), releaseCoeffs.data(), slowCoeffs.data()},
+                                 beginBin, endBin);
+            computeGains(detector.gainReductionsDB, detector.gains, beginBin, endBin);
+        }
+
+        for(int ch = group.firstChannel; ch < endChannel; ++ch)
+            applyGains(detector, this->getFFTBuffer(ch), beginBin, endBin);
+
+        // The analysis taps reuse this frame's levels and gains instead of a second pass
+        if(!analyse)
+            return;
+
+        if(bands != nullptr)
+            bands->interpolateBands(detector.bandGainReductionsDB.data(),
+                                    detector.gainReductionsDB.data(), beginBin, endBin);
+
+        for(int ch = group.firstChannel; ch < endChannel; ++ch) {
+            const auto &state = channelStates[(size_t)ch];
+            auto &analysis = this->getChannelAnalysis(ch);
+            if(bands != nullptr) {
+                // Band detection has no per-bin levels, only the powers; 1e-5 is the level floor
+                for(size_t bin = beginBin; bin < endBin; ++bin)
+                    analysis.dryMagnitudes[bin] = std::max(std::sqrt(state.powers[bin]), 1e-5f);
+            } else {
+                for(size_t bin = beginBin; bin < endBin; ++bin)
+                    analysis.dryMagnitudes[bin]
+                     = FastMath::exp2(state.levelsDB[bin] * LOG2_GAIN_PER_DB);
+            }
+
+            for(size_t bin = beginBin; bin < endBin; ++bin)
+                analysis.wetMagnitudes[bin] = analysis.dryMagnitudes[bin] * detector.gains[bin];
+            std::copy(detector.gainReductionsDB.begin() + beginBin,
+                      detector.gainReductionsDB.begin() + endBin,
+                      analysis.gainReductionsDB.begin() + beginBin);
         }
     }
 
-    float magnitudeToDecibels(float magnitude) const {
-        return (magnitude > MIN_MAGNITUDE_THRESHOLD) ? 20.0f * std::log10(magnitude)
-                                                     : MIN_MAGNITUDE_DB;
+    // The detector levels of a group: the first channel's own, or in a linked group the loudest
+    // channel's per bin or band, collected in the first channel's linked array.
+    template <typename ARRAY>
+    const ARRAY &linkLevels(const ChannelGroup &group, ARRAY ChannelState::*levels,
+                            ARRAY ChannelState::*linkedLevels, size_t begin, size_t end) {
+        auto &detector = channelStates[(size_t)group.firstChannel];
+        if(group.numChannels == 1)
+            return detector.*levels;
+
+        auto &linked = detector.*linkedLevels;
+        std::copy((detector.*levels).begin() + begin, (detector.*levels).begin() + end,
+                  linked.begin() + begin);
+        for(int ch = group.firstChannel + 1; ch < group.firstChannel + group.numChannels; ++ch) {
+            const auto &channelLevels = channelStates[(size_t)ch].*levels;
+            for(size_t i = begin; i < end; ++i)
+                linked[i] = std::max(linked[i], channelLevels[i]);
+        }
+        return linked;
     }
 
-    float decibelsToLinear(float dB) const { return std::pow(10.0f, dB / 20.0f); }
+    // A silent frame would put every bin at the level floor; only its effect on the envelopes is
+    // kept, by counting it until the next processed frame or analysis read.
+    void skipSilentFrame(const ChannelGroup &group, bool analyse) override {
+        auto &detector = channelStates[(size_t)group.firstChannel];
+        if(hopThresholds->hasPeaks)
+            ++detector.skippedFrames;
 
-    float calculateCompression(float magnitudeDB, float thresholdDB, size_t bin) {
-        switch(mode) {
-        case COMPRESSOR: {
-            float gainReductionDB = calculateGainReduction(magnitudeDB, thresholdDB);
-            return applyEnvelopeFollower(bin, gainReductionDB);
-        }
-        case EXPANDER: {
-            float gainIncreaseDB
-             = calculateGainReduction(magnitudeDB, thresholdDB); // >= 0 when above knee
-            float target
-             = (gainIncreaseDB > 0.0f) ? -gainIncreaseDB : 0.0f; // negative value -> boost
-            return applyEnvelopeFollower(bin, target);
-        }
-        case CLIPPER: {
-            float over = magnitudeDB - thresholdDB;
-            float gainReductionDB = (over > 0.0f) ? over : 0.0f;
-            return gainReductionDB;
-        }
-        case GATE: {
-            if(magnitudeDB < thresholdDB)
-                return applyEnvelopeFollower(bin, 100.0f); // 100 dB -> practically mute
+        if(!analyse)
+            return;
+
+        settleEnvelopes(detector);
+        for(int ch = group.firstChannel; ch < group.firstChannel + group.numChannels; ++ch) {
+            auto &analysis = this->getChannelAnalysis(ch);
+            analysis.dryMagnitudes.fill(0.0f);
+            analysis.wetMagnitudes.fill(0.0f);
+
+            if(mode == CLIPPER || !hopThresholds->hasPeaks)
+                analysis.gainReductionsDB.fill(0.0f);
+            else if(bands != nullptr)
+                bands->interpolateBands(detector.bandEnvelopes.data(),
+                                        analysis.gainReductionsDB.data(), 0, NUM_BINS);
             else
-                return applyEnvelopeFollower(bin, 0.0f); // no reduction
+                analysis.gainReductionsDB = detector.envelopeFollowers;
         }
-        default: return 0.0f;
+    }
+
+    void beginFrame(const ChannelGroup &group) override {
+        settleEnvelopes(channelStates[(size_t)group.firstChannel]);
+        if(bands != nullptr && hopThresholds->hasPeaks)
+            detectBands(group);
+    }
+
+    // Band detection needs whole frames, so it runs here, before the group's bin ranges: every
+    // channel's power is pooled into the bands, then the gain computer and the envelopes run
+    // once per band instead of once per bin.
+    void detectBands(const ChannelGroup &group) {
+        const size_t numBands = bands->getNumBands();
+        for(int ch = group.firstChannel; ch < group.firstChannel + group.numChannels; ++ch) {
+            auto &state = channelStates[(size_t)ch];
+            computePowers(state, this->getFFTBuffer(ch), 0, NUM_BINS);
+            bands->averageBins(state.powers.data(), state.bandLevelsDB.data());
+            for(size_t band = 0; band < numBands; ++band)
+                state.bandLevelsDB[band] = std::max(
+                 DB_PER_LOG2_POWER * FastMath::log2(state.bandLevelsDB[band] + MIN_POWER),
+                 MIN_MAGNITUDE_DB);
         }
+
+        auto &detector = channelStates[(size_t)group.firstChannel];
+        const auto &detectorLevelsDB = linkLevels(group, &ChannelState::bandLevelsDB,
+                                                  &ChannelState::linkedBandLevelsDB, 0, numBands);
+        computeGainReduction(
+         detectorLevelsDB, hopThresholds->bandThresholdsDB[detection], detector.bandEnvelopes,
+         detector.bandSlowEnvelopes, detector.bandGainReductionsDB,
+         {bandAttackCoeffs.data(), bandReleaseCoeffs.data(), bandSlowCoeffs.data()}, 0, numBands);
+        computeGains(detector.bandGainReductionsDB, detector.bandGains, 0, numBands);
     }
 
-    float calculateGainReduction(float inputDB, float thresholdDB) const {
-        const float overThresholdDB = inputDB - thresholdDB;
-        const float halfKnee = kneeWidthDB / 2.0f;
+    // Applies the skipped frames to the envelopes in one go. At a constant level each envelope
+    // moves monotonically towards a fixed target, so k frames of one-pole smoothing are one step
+    // with the coefficient raised to the k-th power. The settings of the resuming hop stand in
+    // for those of the skipped ones. With auto release the envelope's target moves with the
+    // history, so there the step only approximates the frames it replaces.
+    void settleEnvelopes(ChannelState &state) {
+        if(state.skippedFrames == 0)
+            return;
 
-        if(overThresholdDB <= -halfKnee) {
-            return 0.0f;
+        const auto frames = static_cast<float>(state.skippedFrames);
+        state.skippedFrames = 0;
+
+        // Band mode uses the first MAX_BANDS entries of the same arrays
+        static_assert(NUM_BINS >= MAX_BANDS);
+        float *attack = state.settleAttackCoeffs.data();
+        float *release = state.settleReleaseCoeffs.data();
+        float *slow = state.settleSlowCoeffs.data();
+        if(bands != nullptr) {
+            const size_t numBands = bands->getNumBands();
+            raiseCoefficients(bandAttackCoeffs.data(), frames, attack, numBands);
+            raiseCoefficients(bandReleaseCoeffs.data(), frames, release, numBands);
+            raiseCoefficients(bandSlowCoeffs.data(), frames, slow, numBands);
+            state.bandLevelsDB.fill(MIN_MAGNITUDE_DB);
+            computeGainReduction(state.bandLevelsDB, hopThresholds->bandThresholdsDB[detection],
+                                 state.bandEnvelopes, state.bandSlowEnvelopes,
+                                 state.bandGainReductionsDB, {attack, release, slow}, 0, numBands);
+        } else {
+            raiseCoefficients(attackCoeffs.data(), frames, attack, NUM_BINS);
+            raiseCoefficients(releaseCoeffs.data(), frames, release, NUM_BINS);
+            raiseCoefficients(slowCoeffs.data(), frames, slow, NUM_BINS);
+            state.levelsDB.fill(MIN_MAGNITUDE_DB);
+            computeGainReduction(state.levelsDB, hopThresholds->thresholdsDB,
+                                 state.envelopeFollowers, state.slowEnvelopes,
+                                 state.gainReductionsDB, {attack, release, slow}, 0, NUM_BINS);
         }
+    }
 
-        if(overThresholdDB >= halfKnee) {
-            return overThresholdDB * (1.0f - 1.0f / ratio);
+    // coeffs^frames, the coefficient of that many hops in one
+    void raiseCoefficients(const float *coeffs, float frames, float *raised, size_t count) const {
+        if(timeTilt == 1.0f) {
+            std::fill(raised, raised + count, std::pow(coeffs[0], frames));
+            return;
         }
 
-        const float kneePosition = overThresholdDB + halfKnee;
-        const float kneeCurve = (kneePosition * kneePosition) / (2.0f * kneeWidthDB);
-        return kneeCurve * (1.0f - 1.0f / ratio);
+        // The compiled coefficients are normal floats, as FastMath::log2 needs
+        for(size_t i = 0; i < count; ++i)
+            raised[i] = FastMath::exp2(frames * FastMath::log2(coeffs[i]));
     }
 
-    float applyEnvelopeFollower(size_t bin, float targetGainReductionDB) {
-        const float currentEnvelope = envelopeFollowers[bin];
-        const float smoothingCoeff
-         = (targetGainReductionDB > currentEnvelope) ? attackCoeff : releaseCoeff;
-        const float newEnvelope
-         = smoothingCoeff * currentEnvelope + (1.0f - smoothingCoeff) * targetGainReductionDB;
-        envelopeFollowers[bin] = newEnvelope;
-        return newEnvelope;
+    void computeLevels(ChannelState &state, const std::array<float, FFT_SIZE * 2> &buffer,
+                       size_t beginBin, size_t endBin) const {
+        computePowers(state, buffer, beginBin, endBin);
+        for(size_t bin = beginBin; bin < endBin; ++bin) {
+            const float levelDB
+             = DB_PER_LOG2_POWER * FastMath::log2(state.powers[bin] + MIN_POWER);
+            state.levelsDB[bin] = std::max(levelDB, MIN_MAGNITUDE_DB);
+        }
     }
 
-    float calculateGaussianSum(float frequency, const std::vector<GaussianPeak> &peaks) const {
-        const float responseCurveShiftDB = responseCurve.getResponseCurveShiftDB();
-        const float logFreq = std::log10(frequency);
-        float thresholdDB = 0.0f;
-        for(const auto &peak : peaks) {
-            const float peakLogFreq = std::log10(peak.frequency);
-            const float logFrequencyDelta = logFreq - peakLogFreq;
-            const float exponent
-             = -0.5f * (logFrequencyDelta * logFrequencyDelta) / (peak.sigmaNorm * peak.sigmaNorm);
-            const float gaussianValue = std::exp(exponent);
-            thresholdDB += peak.gainDB * gaussianValue;
+    void computePowers(ChannelState &state, const std::array<float, FFT_SIZE * 2> &buffer,
+                       size_t beginBin, size_t endBin) const {
+        // Bins are interleaved (real, imag)
+        const float scaleSquared = scale * scale;
+        for(size_t bin = beginBin; bin < endBin; ++bin) {
+            const float real = buffer[2 * bin];
+            const float imag = buffer[2 * bin + 1];
+            state.powers[bin] = (real * real + imag * imag) * scaleSquared;
         }
 
-        return thresholdDB + responseCurveShiftDB;
+        // DC and Nyquist are purely real and scaled like a one-sided bin
+        const float edgeScaleSquared = dcNyquistScale * dcNyquistScale;
+        for(const size_t bin : {(size_t)0, NUM_BINS - 1}) {
+            if(bin < beginBin || bin >= endBin)
+                continue;
+
+            const float real = buffer[2 * bin];
+            const float imag = buffer[2 * bin + 1];
+            state.powers[bin] = (real * real + imag * imag) * edgeScaleSquared;
+        }
     }
 
-    std::array<float, NUM_BINS> gainReductionArray{};
-    std::array<float, NUM_BINS> envelopeFollowers{};
+    // Leaves the (smoothed) gain reduction of every bin or band in the range in
+    // gainReductionsDB. The mode and the auto release are latched once per hop and select a
+    // kernel specialised for them at compile time, so the loop itself has no switch.
+    template <typename ARRAY>
+    void computeGainReduction(const ARRAY &levelsDB, const ARRAY &thresholdsDB, ARRAY &envelopes,
+                              ARRAY &slowEnvelopes, ARRAY &gainReductionsDB,
+                              const EnvelopeCoefficients &coeffs, size_t begin, size_t end) const {
+        switch(mode) {
+        case COMPRESSOR:
+            computeGainReduction<COMPRESSOR>(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                             gainReductionsDB, coeffs, begin, end);
+            break;
+        case EXPANDER:
+            computeGainReduction<EXPANDER>(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                           gainReductionsDB, coeffs, begin, end);
+            break;
+        case CLIPPER:
+            computeGainReduction<CLIPPER>(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                          gainReductionsDB, coeffs, begin, end);
+            break;
+        case GATE:
+            computeGainReduction<GATE>(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                       gainReductionsDB, coeffs, begin, end);
+            break;
+        default:
+            std::fill(gainReductionsDB.begin() + begin, gainReductionsDB.begin() + end, 0.0f);
+            break;
+        }
+    }
 
-    CompressorMode mode = COMPRESSOR;
+    template <CompressorMode MODE, typename ARRAY>
+    void computeGainReduction(const ARRAY &levelsDB, const ARRAY &thresholdsDB, ARRAY &envelopes,
+                              ARRAY &slowEnvelopes, ARRAY &gainReductionsDB,
+                              const EnvelopeCoefficients &coeffs, size_t begin, size_t end) const {
+        // Only the compressor releases automatically, so only its kernel is built both ways
+        if constexpr(MODE == COMPRESSOR) {
+            if(autoRelease) {
+                computeGainReduction<MODE, true>(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                                 gainReductionsDB, coeffs, begin, end);
+                return;
+            }
+        }
+        computeGainReduction<MODE, false>(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                          gainReductionsDB, coeffs, begin, end);
+    }
 
-    float ratio = 4.0f;
-    float kneeWidthDB = 3.0f;
+    template <CompressorMode MODE, bool AUTO_RELEASE, typename ARRAY>
+    void computeGainReduction(const ARRAY &levelsDB, const ARRAY &thresholdsDB, ARRAY &envelopes,
+                              ARRAY &slowEnvelopes, ARRAY &gainReductionsDB,
+                              const EnvelopeCoefficients &coeffs, size_t begin, size_t end) const {
+        const float shiftDB = hopShiftDB;
+        const float *attack = coeffs.attack;
+        const float *release = coeffs.release;
+        const float *slow = coeffs.slow;
+
+        // Soft knee without branches: the quadratic part is the overshoot clamped to the knee,
+        // the linear part whatever lies above it. Both vanish below the knee.
+        const float kneeDB = hopKneeDB;
+        const float slope = hopSlope;
+        const float halfKnee = kneeDB * 0.5f;
+        const float inverseTwoKnee = (kneeDB > 0.0f) ? 1.0f / (2.0f * kneeDB) : 0.0f;
+        auto staticCurve = [kneeDB, slope, halfKnee, inverseTwoKnee](float overDB) {
+            const float inKnee = std::clamp(overDB + halfKnee, 0.0f, kneeDB);
+            return (inKnee * inKnee * inverseTwoKnee + std::max(overDB - halfKnee, 0.0f)) * slope;
+        };
+
+        for(size_t i = begin; i < end; ++i) {
+            const float overDB = levelsDB[i] - (thresholdsDB[i] + shiftDB);
+
+            float targetDB;
+            if constexpr(MODE == COMPRESSOR)
+                targetDB = staticCurve(overDB);
+            else if constexpr(MODE == EXPANDER)
+                targetDB = -staticCurve(overDB); // negative reduction -> boost
+            else if constexpr(MODE == CLIPPER)
+                targetDB = std::max(overDB, 0.0f);
+            else
+                targetDB = (overDB < 0.0f) ? GATE_REDUCTION_DB : 0.0f;
+
+            if constexpr(MODE == CLIPPER) {
+                // Instantaneous, no envelope
+                gainReductionsDB[i] = targetDB;
+            } else {
+                if constexpr(AUTO_RELEASE) {
+                    // The slow envelope remembers how much reduction the bin has needed lately.
+                    // Releasing no further than to it lets a transient's reduction recover at
+                    // the release time, while a sustained one recovers at the slow time.
+                    const float history
+                     = slow[i] * slowEnvelopes[i] + (1.0f - slow[i]) * targetDB;
+                    slowEnvelopes[i] = history;
+                    targetDB = std::max(targetDB, history);
+                }
+
+                // One-pole smoothing towards the target, attack while the reduction grows
+                const float envelope = envelopes[i];
+                const float attackCoeff = attack[i];
+                const float releaseCoeff = release[i];
+                const float coeff = (targetDB > envelope) ? attackCoeff : releaseCoeff;
+                const float smoothed = coeff * envelope + (1.0f - coeff) * targetDB;
+                envelopes[i] = smoothed;
+                gainReductionsDB[i] = smoothed;
+            }
+        }
+    }
 
-    float attackTimeMs = 10.0f;
-    float releaseTimeMs = 100.0f;
+    // Decibels::decibelsToGain(-reduction), including its floor at -100 dB
+    template <typename ARRAY>
+    static void computeGains(const ARRAY &gainReductionsDB, ARRAY &gains, size_t begin,
+                             size_t end) {
+        for(size_t i = begin; i < end; ++i)
+            gains[i] = FastMath::exp2(gainReductionsDB[i] * -LOG2_GAIN_PER_DB);
 
-    float attackCoeff = 0.0f;
-    float releaseCoeff = 0.0f;
+        // A separate pass, so the select above cannot turn into a branch around exp2
+        for(size_t i = begin; i < end; ++i)
+            gains[i] = (gainReductionsDB[i] < -MIN_MAGNITUDE_DB) ? gains[i] : 0.0f;
+    }
+
+    static void applyGains(const ChannelState &state, std::array<float, FFT_SIZE * 2> &buffer,
+                           size_t beginBin, size_t endBin) {
+        for(size_t bin = beginBin; bin < endBin; ++bin) {
+            buffer[2 * bin] *= state.gains[bin];
+            buffer[2 * bin + 1] *= state.gains[bin];
+        }
+    }
+
+    std::array<ChannelState, NUM_CHANNELS> channelStates;
+    std::array<int, NUM_CHANNELS> detectorChannels; // first channel of each channel's group
+    ChannelGroups layoutGroups;
+    ChannelLink link = UNLINKED;
+    DetectionScale detection = PER_BIN;
+    std::array<std::shared_ptr<const BandLayout>, NUM_DETECTION_SCALES> bandLayouts;
+    const BandLayout *bands = nullptr; // the detected scale's layout, null for PER_BIN
+
+    DynamicsParameterSource parameterSource;
+
+    // Read by the displays, on a cache line apart from the per-hop settings
+    alignas(CACHE_LINE_SIZE) std::atomic<CompressorMode> latchedMode{COMPRESSOR};
+
+    // Per-hop settings; only the audio thread touches them once processing runs
+    alignas(CACHE_LINE_SIZE) CompressorMode mode = COMPRESSOR;
+    juce::SmoothedValue<float> ratio{4.0f};
+    juce::SmoothedValue<float> kneeWidthDB{3.0f};
+    juce::SmoothedValue<float> attackTimeMs{10.0f};
+    juce::SmoothedValue<float> releaseTimeMs{100.0f};
+
+    int blockLength = 0;  // samples in the current block
+    int rampPosition = 0; // sample of the current block the ramps have reached
+
+    const ThresholdTable *hopThresholds = nullptr;
+    float hopShiftDB = 0.0f;
+    float hopKneeDB = 3.0f;
+    float hopSlope = 0.75f;
+    float coefficientsAttackMs = 0.0f;
+    float coefficientsReleaseMs = 0.0f;
+    float timeTilt = 1.0f; // time scale per octave above TIME_TILT_PIVOT_HZ
+    bool autoRelease = false;
+
+    // Envelope coefficients of every bin and every band, compiled when a time or the tilt moves
+    alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> attackCoeffs{};
+    alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> releaseCoeffs{};
+    alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandAttackCoeffs{};
+    alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandReleaseCoeffs{};
+    alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> slowCoeffs{};
+    alignas(CACHE_LINE_SIZE) std::array<float, MAX_BANDS> bandSlowCoeffs{};
+    alignas(CACHE_LINE_SIZE) std::array<float, NUM_BINS> inverseTimeScales{};
 
-    float nyquist = 0.0f;
     float scale = 0.0f;
     float dcNyquistScale = 0.0f;
 
     GaussianResponseCurve &responseCurve;
+    TripleBuffer<ThresholdTable> thresholdTables;
+    std::mutex thresholdBuildMutex;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectralDynamicsProcessor)
 };
+
+// Every selectable resolution (Parameters::FFT_SIZES) at every channel capacity of
+// MultiResolutionProcessor is instantiated once, in SpectralCompressor.cpp, instead of in each
+// translation unit that includes this header.
+extern template class FFTProcessor<512>;
+extern template class FFTProcessor<1024>;
+extern template class FFTProcessor<2048>;
+extern template class FFTProcessor<4096>;
+extern template class FFTProcessor<8192>;
+extern template class FFTProcessor<16384>;
+extern template class FFTProcessor<512, 3>;
+extern template class FFTProcessor<1024, 3>;
+extern template class FFTProcessor<2048, 3>;
+extern template class FFTProcessor<4096, 3>;
+extern template class FFTProcessor<8192, 3>;
+extern template class FFTProcessor<16384, 3>;
+extern template class FFTProcessor<512, 6>;
+extern template class FFTProcessor<1024, 6>;
+extern template class FFTProcessor<2048, 6>;
+extern template class FFTProcessor<4096, 6>;
+extern template class FFTProcessor<8192, 6>;
+extern template class FFTProcessor<16384, 6>;
+extern template class FFTProcessor<512, 8>;
+extern template class FFTProcessor<1024, 8>;
+extern template class FFTProcessor<2048, 8>;
+extern template class FFTProcessor<4096, 8>;
+extern template class FFTProcessor<8192, 8>;
+extern template class FFTProcessor<16384, 8>;
+
+extern template class SpectralDynamicsProcessor<512>;
+extern template class SpectralDynamicsProcessor<1024>;
+extern template class SpectralDynamicsProcessor<2048>;
+extern template class SpectralDynamicsProcessor<4096>;
+extern template class SpectralDynamicsProcessor<8192>;
+extern template class SpectralDynamicsProcessor<16384>;
+extern template class SpectralDynamicsProcessor<512, 3>;
+extern template class SpectralDynamicsProcessor<1024, 3>;
+extern template class SpectralDynamicsProcessor<2048, 3>;
+extern template class SpectralDynamicsProcessor<4096, 3>;
+extern template class SpectralDynamicsProcessor<8192, 3>;
+extern template class SpectralDynamicsProcessor<16384, 3>;
+extern template class SpectralDynamicsProcessor<512, 6>;
+extern template class SpectralDynamicsProcessor<1024, 6>;
+extern template class SpectralDynamicsProcessor<2048, 6>;
+extern template class SpectralDynamicsProcessor<4096, 6>;
+extern template class SpectralDynamicsProcessor<8192, 6>;
+extern template class SpectralDynamicsProcessor<16384, 6>;
+extern template class SpectralDynamicsProcessor<512, 8>;
+extern template class SpectralDynamicsProcessor<1024, 8>;
+extern template class SpectralDynamicsProcessor<2048, 8>;
+extern template class SpectralDynamicsProcessor<4096, 8>;
+extern template class SpectralDynamicsProcessor<8192, 8>;
+extern template class SpectralDynamicsProcessor<16384, 8>;
@@ -0,0 +1,76 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <span>
+
+class WorkerPool;
+
+enum CompressorMode { COMPRESSOR, EXPANDER, CLIPPER, GATE };
+
+// Which channels share one detector: none, the groups of the bus layout, or all of them.
+enum ChannelLink { UNLINKED, LINK_GROUPS, LINK_ALL };
+
+// What the detector resolves: every bin on its own, or the bins pooled into perceptual bands
+// (see BandLayout) whose gains are interpolated back to the bins.
+enum DetectionScale { PER_BIN, ERB_BANDS, BARK_BANDS, THIRD_OCTAVE_BANDS, SIXTH_OCTAVE_BANDS };
+static constexpr size_t NUM_DETECTION_SCALES = 5;
+
+// The bus layout as runs of adjacent channels that belong together, e.g. {2, 1, 1, 2} for 5.1
+// (L/R, C, LFE, Ls/Rs). Every supported layout keeps its pairs adjacent.
+struct ChannelGroups {
+    static constexpr int MAX_GROUPS = 8;
+    std::array<int, MAX_GROUPS> sizes{1};
+    int numGroups = 1;
+};
+
+// The plugin parameters the engines follow, as the raw atomics of the value tree state. Engines
+// read them on the audio thread once per hop; a null entry keeps the engine's default.
+struct DynamicsParameterSource {
+    const std::atomic<float> *compressorMode = nullptr; // choice index of CompressorMode
+    const std::atomic<float> *attackTimeMs = nullptr;
+    const std::atomic<float> *releaseTimeMs = nullptr;
+    const std::atomic<float> *ratio = nullptr;
+    const std::atomic<float> *kneeDB = nullptr;
+    const std::atomic<float> *channelLink = nullptr; // choice index of ChannelLink
+    const std::atomic<float> *detectionScale = nullptr; // choice index of DetectionScale
+    const std::atomic<float> *timeTilt = nullptr; // time scale per octave above 1 kHz
+    const std::atomic<float> *autoRelease = nullptr; // bool, compressor mode only
+};
+
+// Size-independent view of a SpectralDynamicsProcessor instantiation, so the plugin and the UI can
+// hold whichever frame size is currently selected without being templated on it.
+class SpectralEngine {
+  public:
+    virtual ~SpectralEngine() = default;
+
+    // overlapFactor is the number of frames covering each sample; the hop is FFT size / overlap.
+    virtual void prepareToPlay(double sampleRate, size_t overlapFactor) = 0;
+    // Clears all signal state (FIFOs, overlap-add, envelopes) without allocating.
+    virtual void reset() = 0;
+    virtual void processBlock(juce::AudioBuffer<float> &buffer) = 0;
+
+    virtual size_t getFFTSize() const = 0;
+    virtual size_t getHopSize() const = 0;
+    virtual int getLatencySamples() const = 0;
+    virtual double getSampleRate() const = 0;
+
+    // Spreads the channel groups' frames (and the bins of large frames) over the pool; null runs
+    // everything on the calling thread. Only change it while processing is stopped.
+    virtual void setWorkerPool(WorkerPool *pool) = 0;
+
+    // The analysis snapshots below are only updated while enabled.
+    virtual void setAnalysisEnabled(bool shouldAnalyse) = 0;
+    // Latest complete analysis frame; each view stays valid until the next call by its reader.
+    virtual std::span<const float> getProcessedMagnitudes() = 0;
+    virtual std::span<const float> getUnprocessedMagnitudes() = 0;
+    virtual std::span<const float> getGainReductionArray() = 0;
+
+    // Call before processing starts; the source must outlive the engine.
+    virtual void setParameterSource(const DynamicsParameterSource &source) = 0;
+    // The layout's groups, used while the link parameter is LINK_GROUPS. Processing stopped.
+    virtual void setLayoutGroups(const ChannelGroups &newLayoutGroups) = 0;
+    // The mode latched for the most recent hop.
+    virtual CompressorMode getCompressorMode() const = 0;
+};
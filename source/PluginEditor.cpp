@@ -1,4 +1,5 @@
 #include "PluginEditor.h"
+#include "AnalysisControls.h"
 #include "CompressorControls.h"
 #include "CompressorModeSection.h"
 #include "GainControls.h"
@@ -15,16 +16,18 @@ SpectrixAudioProcessorEditor::SpectrixAudioProcessorEditor(SpectrixAudioProcesso
                                                            AudioProcessorValueTreeState &vts)
     : AudioProcessorEditor(&p), audioProcessor(p), compressorControlsSection(vts),
       gainControlSection(vts), compressionModeSection(vts, compressorControlsSection),
-      spectrumSection(p), meteringSecttion(p) {
+      spectrumSection(p), meteringSecttion(p), analysisSection(vts) {
     addAndMakeVisible(spectrumSection);
     addAndMakeVisible(compressorControlsSection);
     addAndMakeVisible(gainControlSection);
     addAndMakeVisible(compressionModeSection);
     addAndMakeVisible(meteringSecttion);
+    addAndMakeVisible(analysisSection);
 
     compressorControlsSection.setLookAndFeel(&theme);
     gainControlSection.setLookAndFeel(&theme);
     compressionModeSection.setLookAndFeel(&theme);
+    analysisSection.setLookAndFeel(&theme);
 
     pluginTitleImage
      = juce::ImageCache::getFromMemory(BinaryData::logo_png, BinaryData::logo_pngSize);
@@ -47,6 +50,7 @@ SpectrixAudioProcessorEditor::~SpectrixAudioProcessorEditor() {
     compressorControlsSection.setLookAndFeel(nullptr);
     gainControlSection.setLookAndFeel(nullptr);
     compressionModeSection.setLookAndFeel(nullptr);
+    analysisSection.setLookAndFeel(nullptr);
 }
 
 void SpectrixAudioProcessorEditor::paint(juce::Graphics &g) {
@@ -89,6 +93,10 @@ void SpectrixAudioProcessorEditor::resized() {
     meteringSecttion.setBounds(topSectionBounds.withTrimmedLeft(bounds.getWidth() * 0.975));
     spectrumSection.setBounds(topSectionBounds.withTrimmedRight(bounds.getWidth() * 0.025)
                                .removeFromBottom(topSectionBounds.getHeight() - 75));
+    analysisSection.setBounds(topSectionBounds.withTrimmedRight(bounds.getWidth() * 0.025)
+                               .removeFromTop(75)
+                               .reduced(10, 15)
+                               .removeFromRight(AnalysisSection::getPreferredWidth()));
 
     int trim = bottomSectionBounds.getWidth() * 0.2 + 40;
     compressorControlsSection.setBounds(
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AnalysisControls.h"
 #include "CompressorControls.h"
 #include "CompressorModeSection.h"
 #include "GainControls.h"
@@ -28,6 +29,7 @@ class SpectrixAudioProcessorEditor : public juce::AudioProcessorEditor {
     GainControlSection gainControlSection;
     CompressionModeSection compressionModeSection;
     MeteringSection meteringSecttion;
+    AnalysisSection analysisSection;
 
     SpectrixAudioProcessor &audioProcessor;
 
@@ -2,9 +2,13 @@
 #include "juce_audio_processors/juce_audio_processors.h"
 #include "juce_core/juce_core.h"
 #include <JuceHeader.h>
+#include <array>
 
 namespace Parameters {
-    static const int FFT_SIZE = 4096;
+    // Selectable STFT frame sizes; every one has an engine instantiated in SpectralCompressor.cpp
+    static constexpr std::array<size_t, 6> FFT_SIZES = {512, 1024, 2048, 4096, 8192, 16384};
+    // Frames covering each sample; the hop size is FFT size / overlap
+    static constexpr std::array<size_t, 3> OVERLAP_FACTORS = {2, 4, 8};
     static const int FPS = 30;
 
     // Parameter IDs
@@ -16,6 +20,12 @@ namespace Parameters {
     static const String inputGainID = "IG";
     static const String outputGainID = "OG";
     static const String ratioID = "RA";
+    static const String resolutionID = "RS";
+    static const String overlapID = "OV";
+    static const String channelLinkID = "LK";
+    static const String detectionScaleID = "DT";
+    static const String timeTiltID = "TT";
+    static const String autoReleaseID = "AR";
 
     // Default values
     static const float defaultCurveShiftDB = 0.0f;
@@ -26,12 +36,20 @@ namespace Parameters {
     static const float defaultOutputGain = 0.0f;    // dB
     static const float defaultRatio = 4.0f;
     static const int defaultCompressorMode = 0;
+    static const int defaultResolutionIndex = 3; // 4096
+    static const int defaultOverlapIndex = 1;    // 4x
+    static const int defaultChannelLink = 0;     // off, as before linking existed
+    static const int defaultDetectionScale = 0;  // per bin, as before bands existed
+    static const float defaultTimeTilt = 1.0f;   // same times at every frequency
+    static const bool defaultAutoRelease = false;
 
     // MIN MAX BOUNDS
     static const float minAttack = 1.0f;
     static const float maxAttack = 1000.0f;
     static const float minRelease = 10.0f;
     static const float maxRelease = 1000.0f;
+    static const float minTimeTilt = 0.5f; // times per octave up, relative to 1 kHz
+    static const float maxTimeTilt = 2.0f;
     static const float minCurveShift = -96.0f;
     static const float maxCurveShift = 12.0f;
     static const float minRatio = 1.0f;
@@ -48,6 +66,8 @@ namespace Parameters {
     static const float skewFactorAttack = 0.5f;
     static const float stepSizeRelease = 1.0f;
     static const float skewFactorRelease = 0.3f;
+    static const float stepSizeTimeTilt = 0.01f;
+    static const float skewFactorTimeTilt = 0.63f; // 1x at the centre
     static const float stepSizeCurveShift = 0.1f;
     static const float skewFactorCurveShift = 1.0f;
     static const float stepSizeRatio = 0.1f;
@@ -109,15 +129,40 @@ namespace Parameters {
          ParameterID("OG", id++), "Output Gain",
          NormalisableRange<float>(-24.0f, 24.0f, 0.1f, 1.0f), defaultOutputGain));
 
-        return {params.begin(), params.end()};
-    }
+        // FFT Resolution
+        StringArray resolutionChoices;
+        for(auto size : FFT_SIZES)
+            resolutionChoices.add(String(size));
+        params.push_back(std::make_unique<AudioParameterChoice>(
+         ParameterID(resolutionID, id++), "Resolution", resolutionChoices, defaultResolutionIndex));
+
+        // Overlap
+        StringArray overlapChoices;
+        for(auto factor : OVERLAP_FACTORS)
+            overlapChoices.add(String(factor) + "x");
+        params.push_back(std::make_unique<AudioParameterChoice>(
+         ParameterID(overlapID, id++), "Overlap", overlapChoices, defaultOverlapIndex));
+
+        // Channel Link, in the order of ChannelLink
+        params.push_back(std::make_unique<AudioParameterChoice>(
+         ParameterID(channelLinkID, id++), "Channel Link", StringArray{"Off", "Groups", "All"},
+         defaultChannelLink));
 
-    static void addListeners(AudioProcessorValueTreeState &valueTreeState,
-                             AudioProcessorValueTreeState::Listener *listener) {
-        std::unique_ptr<XmlElement> xml(valueTreeState.copyState().createXml());
-        for(auto *element : xml->getChildWithTagNameIterator("PARAM")) {
-            const String &id = element->getStringAttribute("id");
-            valueTreeState.addParameterListener(id, listener);
-        }
+        // Detection, in the order of DetectionScale
+        params.push_back(std::make_unique<AudioParameterChoice>(
+         ParameterID(detectionScaleID, id++), "Detection",
+         StringArray{"Bins", "ERB", "Bark", "1/3 Oct", "1/6 Oct"}, defaultDetectionScale));
+
+        // Time Tilt
+        params.push_back(std::make_unique<AudioParameterFloat>(
+         ParameterID(timeTiltID, id++), "Time Tilt",
+         NormalisableRange<float>(minTimeTilt, maxTimeTilt, stepSizeTimeTilt, skewFactorTimeTilt),
+         defaultTimeTilt));
+
+        // Auto Release
+        params.push_back(std::make_unique<AudioParameterBool>(
+         ParameterID(autoReleaseID, id++), "Auto Release", defaultAutoRelease));
+
+        return {params.begin(), params.end()};
     }
 } // namespace Parameters
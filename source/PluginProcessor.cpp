@@ -1,7 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "PluginParameters.h"
-#include "SpectralCompressor.h"
+#include "MultiResolutionProcessor.h"
 
 //==============================================================================
 SpectrixAudioProcessor::SpectrixAudioProcessor()
@@ -9,33 +9,58 @@ SpectrixAudioProcessor::SpectrixAudioProcessor()
                       .withInput("Input", AudioChannelSet::stereo(), true)
                       .withOutput("Output", AudioChannelSet::stereo(), true)),
       spectralCompressor(responseCurve),
-      parameters(*this, nullptr, "SpectrixParams", Parameters::createParameterLayout())
+      parameters(*this, nullptr, "SpectrixParams", Parameters::createParameterLayout()),
+      curveShiftDB(parameters.getRawParameterValue(Parameters::curveShiftDBID)),
+      resolutionIndex(parameters.getRawParameterValue(Parameters::resolutionID)),
+      inputGainDB(parameters.getRawParameterValue(Parameters::inputGainID)),
+      outputGainDB(parameters.getRawParameterValue(Parameters::outputGainID))
 
 {
-    Parameters::addListeners(parameters, this);
+    // The engines read these atomics once per hop, so their changes need no listener callback
+    spectralCompressor.setParameterSource(
+     {.compressorMode = parameters.getRawParameterValue(Parameters::compressorModeID),
+      .attackTimeMs = parameters.getRawParameterValue(Parameters::attackTimeID),
+      .releaseTimeMs = parameters.getRawParameterValue(Parameters::releaseTimeID),
+      .ratio = parameters.getRawParameterValue(Parameters::ratioID),
+      .kneeDB = parameters.getRawParameterValue(Parameters::kneeWidthID),
+      .channelLink = parameters.getRawParameterValue(Parameters::channelLinkID),
+      .detectionScale = parameters.getRawParameterValue(Parameters::detectionScaleID),
+      .timeTilt = parameters.getRawParameterValue(Parameters::timeTiltID),
+      .autoRelease = parameters.getRawParameterValue(Parameters::autoReleaseID)});
+
+    // Only the overlap needs a callback: applying it re-prepares the engines
+    parameters.addParameterListener(Parameters::overlapID, this);
 }
 
 SpectrixAudioProcessor::~SpectrixAudioProcessor() {}
 
 //==============================================================================
 void SpectrixAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
-    spectralCompressor.prepareToPlay(sampleRate);
-    setLatencySamples(Parameters::FFT_SIZE - 1);
+    // Offline renders can afford to block on worker threads; real-time playback stays serial
+    spectralCompressor.setNumThreads(isNonRealtime() ? juce::SystemStats::getNumCpus() : 1);
+    // Start at the stored resolution and curve shift rather than switching on the first block
+    spectralCompressor.setResolution(static_cast<size_t>(resolutionIndex->load()));
+    responseCurve.setResponseCurveShiftDB(curveShiftDB->load());
+    const auto layout = getBusesLayout().getMainOutputChannelSet();
+    spectralCompressor.prepareToPlay(sampleRate, samplesPerBlock, getOverlapFactor(),
+                                     layout.size(), getChannelGroups(layout));
+    reportLatency();
 
     if(auto *editor = dynamic_cast<SpectrixAudioProcessorEditor *>(getActiveEditor())) {
         editor->prepareToPlay(sampleRate, samplesPerBlock);
     }
 
     inputGain.reset(sampleRate, 0.05);
-    inputGain.setCurrentAndTargetValue(1.0);
+    inputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(inputGainDB->load()));
     outputGain.reset(sampleRate, 0.05);
-    outputGain.setCurrentAndTargetValue(1.0);
+    outputGain.setCurrentAndTargetValue(juce::Decibels::decibelsToGain(outputGainDB->load()));
 }
 void SpectrixAudioProcessor::releaseResources() {}
 
 void SpectrixAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                           juce::MidiBuffer &midiMessages) {
     juce::ScopedNoDenormals noDenormals;
+    readBlockParameters();
 
     int numCh = buffer.getNumChannels();
     auto bufferData = buffer.getArrayOfWritePointers();
@@ -47,6 +72,12 @@ void SpectrixAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
 
     spectralCompressor.processBlock(buffer);
 
+    // A resolution switch completes on the audio thread; the new engine's latency is reported
+    // from the message thread, as hosts may re-prepare from within setLatencySamples.
+    if(spectralCompressor.getLatencySamples()
+       != reportedLatencySamples.load(std::memory_order_relaxed))
+        triggerAsyncUpdate();
+
     for(int ch = 0; ch < numCh; ++ch)
         outputGain.applyGain(bufferData[ch], buffer.getNumSamples());
 
@@ -79,8 +110,10 @@ void SpectrixAudioProcessor::setStateInformation(const void *data, int sizeInByt
     }
 }
 bool SpectrixAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const {
-    if(layouts.getMainOutputChannelSet() != AudioChannelSet::mono()
-       && layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
+    const auto output = layouts.getMainOutputChannelSet();
+    if(output != AudioChannelSet::mono() && output != AudioChannelSet::stereo()
+       && output != AudioChannelSet::createLCR() && output != AudioChannelSet::create5point1()
+       && output != AudioChannelSet::create7point1())
         return false;
 
     if(layouts.getMainInputChannelSet() != layouts.getMainOutputChannelSet())
@@ -89,45 +122,72 @@ bool SpectrixAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts)
     return true;
 }
 
-void SpectrixAudioProcessor::parameterChanged(const String &paramID, float newValue) {
-    if(paramID == Parameters::curveShiftDBID) {
-        responseCurve.setResponseCurveShiftDB(newValue);
-    }
+// Plain atomic loads and stores; a target equal to the current one leaves a smoother untouched.
+void SpectrixAudioProcessor::readBlockParameters() {
+    responseCurve.setResponseCurveShiftDB(curveShiftDB->load(std::memory_order_relaxed));
+    spectralCompressor.setResolution(
+     static_cast<size_t>(resolutionIndex->load(std::memory_order_relaxed)));
+    inputGain.setTargetValue(
+     juce::Decibels::decibelsToGain(inputGainDB->load(std::memory_order_relaxed)));
+    outputGain.setTargetValue(
+     juce::Decibels::decibelsToGain(outputGainDB->load(std::memory_order_relaxed)));
+}
 
-    if(paramID == Parameters::attackTimeID) {
-        spectralCompressor.setAttackTime(newValue);
-    }
+// Only registered for the overlap.
+void SpectrixAudioProcessor::parameterChanged(const String &, float) {
+    // The hop is fixed while playing; re-prepare on the message thread to apply it.
+    overlapChangePending.store(true);
+    triggerAsyncUpdate();
+}
 
-    if(paramID == Parameters::releaseTimeID) {
-        spectralCompressor.setReleaseTime(newValue);
-    }
+void SpectrixAudioProcessor::handleAsyncUpdate() {
+    if(getSampleRate() <= 0.0)
+        return;
 
-    if(paramID == Parameters::ratioID) {
-        spectralCompressor.setRatio(newValue);
+    if(overlapChangePending.exchange(false)) {
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
     }
 
-    if(paramID == Parameters::kneeWidthID) {
-        spectralCompressor.setKnee(newValue);
-    }
+    reportLatency();
+}
 
-    if(paramID == Parameters::compressorModeID) {
-        int compressorTypeIndex = static_cast<int>(newValue);
-        switch(compressorTypeIndex) {
-        case 0: spectralCompressor.setCompressorMode(COMPRESSOR); break;
-        case 1: spectralCompressor.setCompressorMode(EXPANDER); break;
-        case 2: spectralCompressor.setCompressorMode(CLIPPER); break;
-        case 3: spectralCompressor.setCompressorMode(GATE); break;
-        default: spectralCompressor.setCompressorMode(COMPRESSOR);
-        }
-    }
+// Message thread, or while processing is stopped.
+void SpectrixAudioProcessor::reportLatency() {
+    const int latency = spectralCompressor.getLatencySamples();
+    reportedLatencySamples.store(latency, std::memory_order_relaxed);
+    if(latency != getLatencySamples())
+        setLatencySamples(latency);
+}
 
-    if(paramID == Parameters::inputGainID) {
-        inputGain.setTargetValue(juce::Decibels::decibelsToGain(newValue));
-    }
+// JUCE orders these layouts L R C LFE Ls Rs Lrs Rrs (see AudioChannelSet), so every pair that
+// linking should keep together is adjacent.
+ChannelGroups SpectrixAudioProcessor::getChannelGroups(const AudioChannelSet &layout) {
+    ChannelGroups groups;
+    auto add = [&groups](std::initializer_list<int> sizes) {
+        groups.numGroups = 0;
+        for(const int size : sizes)
+            groups.sizes[(size_t)groups.numGroups++] = size;
+    };
+
+    if(layout == AudioChannelSet::stereo())
+        add({2});
+    else if(layout == AudioChannelSet::createLCR())
+        add({2, 1});
+    else if(layout == AudioChannelSet::create5point1())
+        add({2, 1, 1, 2});
+    else if(layout == AudioChannelSet::create7point1())
+        add({2, 1, 1, 2, 2});
+    else
+        add({1});
+
+    return groups;
+}
 
-    if(paramID == Parameters::outputGainID) {
-        outputGain.setTargetValue(juce::Decibels::decibelsToGain(newValue));
-    }
+size_t SpectrixAudioProcessor::getOverlapFactor() const {
+    const auto index = static_cast<size_t>(*parameters.getRawParameterValue(Parameters::overlapID));
+    return Parameters::OVERLAP_FACTORS[juce::jmin(index, Parameters::OVERLAP_FACTORS.size() - 1)];
 }
 
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter() { return new SpectrixAudioProcessor(); }
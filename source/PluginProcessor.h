@@ -1,11 +1,13 @@
 #pragma once
-#include "SpectralCompressor.h"
+#include "MultiResolutionProcessor.h"
 #include <JuceHeader.h>
 #include "PluginParameters.h"
 #include "GaussianResponseCurve.h"
+#include "CacheLine.h"
 
 class SpectrixAudioProcessor : public juce::AudioProcessor,
-                               public AudioProcessorValueTreeState::Listener {
+                               public AudioProcessorValueTreeState::Listener,
+                               private juce::AsyncUpdater {
   public:
     //==============================================================================
     SpectrixAudioProcessor();
@@ -54,16 +56,31 @@ class SpectrixAudioProcessor : public juce::AudioProcessor,
     }
 
     GaussianResponseCurve responseCurve;
-    SpectralDynamicsProcessor<Parameters::FFT_SIZE> spectralCompressor;
+    MultiResolutionProcessor spectralCompressor;
 
     SmoothedValue<float, ValueSmoothingTypes::Linear> inputGain, outputGain;
-    Atomic<float> inputProbe;
+
+    // Peak levels written by the audio thread and decayed by the meters. They start a cache line,
+    // so the meters' writes never land on the line of the gain smoothers the audio thread updates
+    alignas(CACHE_LINE_SIZE) Atomic<float> inputProbe;
     Atomic<float> outputProbe;
 
   private:
     void parameterChanged(const String &paramID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void reportLatency();
+    void readBlockParameters();
+    size_t getOverlapFactor() const;
+    static ChannelGroups getChannelGroups(const AudioChannelSet &layout);
 
     AudioProcessorValueTreeState parameters;
+    // Read by the audio thread at the start of every block
+    std::atomic<float> *curveShiftDB, *resolutionIndex, *inputGainDB, *outputGainDB;
+
+    // Set when the overlap changes; the next async update re-prepares to apply it
+    std::atomic<bool> overlapChangePending{false};
+    // The latency last passed to setLatencySamples, for the audio thread to compare against
+    std::atomic<int> reportedLatencySamples{0};
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrixAudioProcessor)
@@ -2,40 +2,50 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <cmath>
-#include "SpectralCompressor.h"
+#include "MultiResolutionProcessor.h"
 #include "UIutils.h"
 #include "PluginParameters.h"
 #include "juce_graphics/juce_graphics.h"
 
-template <int FFTSize>
 class SpectralGainReductionVisualizer : public juce::Component, private juce::Timer {
   public:
-    SpectralGainReductionVisualizer(SpectralDynamicsProcessor<FFTSize> &processorRef,
-                                    double sampleRateHz)
+    SpectralGainReductionVisualizer(MultiResolutionProcessor &processorRef, double sampleRateHz)
         : processor(processorRef), sampleRate(sampleRateHz) {
-        gainReductions.resize((size_t)FFTSize / 2 + 1, 0.0f);
         startTimerHz(Parameters::FPS);
     }
 
-    void setSampleRate(double newSampleRate) { sampleRate = newSampleRate; rebuildBinToX(); }
+    void setSampleRate(double newSampleRate) { sampleRate = newSampleRate; binGeometry = nullptr; }
 
     void paint(juce::Graphics &g) override {
-        // Fetch the latest reductions (copy)
-        auto latest = processor.getGainReductionArray();
-        if(latest.size() == 0)
+        if(sampleRate <= 0.0)
             return;
 
-        updateGainReduction(latest);
+        // Fetch the latest reductions while the engine cannot be replaced; the bin count follows
+        // the active resolution
+        const bool hasFrame = processor.readActiveEngine([this](SpectralEngine &engine) {
+            const auto latest = engine.getGainReductionArray();
+            if(latest.size() == 0)
+                return false;
+
+            if(gainReductions.size() != latest.size())
+                gainReductions.assign(latest.size(), 0.0f);
+
+            updateGainReduction(latest);
+            return true;
+        });
+        if(!hasFrame)
+            return;
 
         auto bounds = getLocalBounds().toFloat();
         juce::Path reductionPath;
         std::vector<juce::Point<float>> points;
         points.reserve(gainReductions.size());
 
-        const float nyquist = static_cast<float>(sampleRate) * 0.5f;
-        const float minFreq = 20.0f;
-        const float logMin = std::log10(minFreq);
-        if (binToX.size() != gainReductions.size()) rebuildBinToX();
+        // Shared with the engines: only fetched when the resolution or sample rate changes
+        if(binGeometry == nullptr || binGeometry->getNumBins() != gainReductions.size())
+            binGeometry = BinGeometry::get(sampleRate, (gainReductions.size() - 1) * 2);
+        const auto &frequencies = binGeometry->frequencies;
+        const auto &displayPositions = binGeometry->displayPositions;
 
         // Get current mode
         CompressorMode currentMode = getCurrentMode();
@@ -50,13 +60,10 @@ class SpectralGainReductionVisualizer : public juce::Component, private juce::Ti
 
         // Build visible points (skip bin 0 which is DC)
         for(size_t i = 1; i < gainReductions.size(); ++i) {
-            float freq = (i * nyquist) / (gainReductions.size() - 1);
-            if(freq < minFreq)
+            if(frequencies[i] < BinGeometry::MIN_DISPLAY_FREQUENCY)
                 continue;
 
-            float x = (i < binToX.size()) ? binToX[i]
-                                         : bounds.getX() + juce::jmap(std::log10(juce::jmax(minFreq, freq)),
-                                                                      std::log10(minFreq), std::log10(nyquist), 0.0f, bounds.getWidth());
+            float x = bounds.getX() + displayPositions[i] * bounds.getWidth();
 
             // Interpret the gain value based on mode and map to equivalent spectrum dB
             float effectiveDB = interpretGainAsSpectrumDB(gainReductions[i], currentMode,
@@ -113,28 +120,11 @@ class SpectralGainReductionVisualizer : public juce::Component, private juce::Ti
         // Gradient fill
     }
 
-    void resized() override { rebuildBinToX(); }
     void visibilityChanged() override { }
   
   private:
     void timerCallback() override { if (isShowing()) repaint(); }
     
-    void rebuildBinToX() {
-        auto b = getLocalBounds().toFloat();
-        if (b.getWidth() <= 0.0f || sampleRate <= 0.0) { binToX.clear(); return; }
-        const float nyquist = static_cast<float>(sampleRate) * 0.5f;
-        const float minFreq = 20.0f;
-        const float logMin = std::log10(minFreq);
-        const float logMax = std::log10(nyquist);
-        const size_t n = gainReductions.size();
-        binToX.resize(n);
-        for (size_t i = 0; i < n; ++i) {
-            const float freq = (i * nyquist) / (n > 1 ? (n - 1) : 1);
-            const float logFreq = std::log10(juce::jmax(minFreq, freq));
-            binToX[i] = b.getX() + juce::jmap(logFreq, logMin, logMax, 0.0f, b.getWidth());
-        }
-    }
-
     CompressorMode getCurrentMode() const { return processor.getCompressorMode(); }
 
     float getBaselineYForMode(CompressorMode mode, const juce::Rectangle<float> &bounds,
@@ -245,7 +235,7 @@ class SpectralGainReductionVisualizer : public juce::Component, private juce::Ti
     }
 
     // Attack/release smoothing of incoming dB values
-    void updateGainReduction(const std::array<float, (size_t)FFTSize / 2 + 1> &newData) {
+    void updateGainReduction(std::span<const float> newData) {
         const float attackCoeff = 0.8f;   // Fast attack
         const float releaseCoeff = 0.92f; // Slower release
 
@@ -290,8 +280,9 @@ class SpectralGainReductionVisualizer : public juce::Component, private juce::Ti
         }
     }
 
-    SpectralDynamicsProcessor<FFTSize> &processor;
+    MultiResolutionProcessor &processor;
+    MultiResolutionProcessor::AnalysisSubscription analysisSubscription{processor};
     std::vector<float> gainReductions;
     double sampleRate;
-    std::vector<float> binToX;
+    std::shared_ptr<const BinGeometry> binGeometry;
 };
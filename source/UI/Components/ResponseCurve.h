@@ -7,6 +7,7 @@
 #include "juce_graphics/juce_graphics.h"
 #include "juce_gui_basics/juce_gui_basics.h"
 #include <JuceHeader.h>
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
@@ -27,8 +28,10 @@ class ResponseCurve : public juce::Component {
 
     void paint(juce::Graphics &g) override {
         responseCurveShiftDB = responseCurve.getResponseCurveShiftDB();
-        if(responseCurve.getGaussianPeaks().size() == 0)
+        if(responseCurve.readPeaks()->empty())
             responseCurve.addPeak({1000.0f, 0.0f, 0.25f});
+        refreshPeaks();
+        updateColumnLogFrequencies();
         drawGaussianCurves(g);
         drawSumOfGaussians(g);
         drawGaussianPeaks(g);
@@ -43,6 +46,7 @@ class ResponseCurve : public juce::Component {
     // ##################
 
     void mouseDown(const juce::MouseEvent &event) override {
+        refreshPeaks();
         auto pos = event.position;
         draggedPeakIndex = -1;
         bool clickedOnPeak = false;
@@ -64,8 +68,9 @@ class ResponseCurve : public juce::Component {
         if(isDoubleClick) {
             if(clickedOnPeak) {
                 responseCurve.deletePeak((size_t)draggedPeakIndex);
-                if(responseCurve.getGaussianPeaks().size() == 0)
+                if(responseCurve.readPeaks()->empty())
                     responseCurve.addPeak({1000.0f, 0.0f, 0.25f});
+                refreshPeaks();
                 draggedPeakIndex = -1;
             } else {
                 auto bounds = getLocalBounds().toFloat();
@@ -73,6 +78,7 @@ class ResponseCurve : public juce::Component {
                 float frequency = std::pow(10.0, logFreq);
                 float gainDB = inverseDBWarp(pos.y, bounds) - responseCurveShiftDB;
                 responseCurve.addPeak({frequency, gainDB, 0.15f});
+                refreshPeaks();
 
                 draggedPeakIndex = (int)(gaussians.size() - 1);
                 dragOffset = {0.0f, 0.0f};
@@ -87,11 +93,12 @@ class ResponseCurve : public juce::Component {
     }
 
     void mouseDrag(const juce::MouseEvent &event) override {
+        refreshPeaks();
         if(draggedPeakIndex < 0 || draggedPeakIndex >= (int)gaussians.size())
             return;
         setMouseCursor(juce::MouseCursor::DraggingHandCursor);
         auto bounds = getLocalBounds().toFloat();
-        auto &peak = gaussians[draggedPeakIndex];
+        auto peak = gaussians[(size_t)draggedPeakIndex];
         if(event.mods.isShiftDown()) {
             float deltaY = event.position.y - mouseDownPos.y;
             float sigmaChange = -deltaY / bounds.getHeight();
@@ -107,6 +114,8 @@ class ResponseCurve : public juce::Component {
             peak.frequency = std::pow(10.0, xToLogFrequency(newX));
             peak.gainDB = inverseDBWarp(newY, bounds) - responseCurveShiftDB;
         }
+        responseCurve.updatePeak((size_t)draggedPeakIndex, peak);
+        gaussians[(size_t)draggedPeakIndex] = peak;
 
         dragInfoLabel.setVisible(true);
         dragInfoLabel.setText(juce::String(peak.frequency, 1) + " Hz", juce::dontSendNotification);
@@ -133,6 +142,7 @@ class ResponseCurve : public juce::Component {
     }
 
     void mouseMove(const juce::MouseEvent &event) override {
+        refreshPeaks();
         auto pos = event.position;
         hoveredPeakIndex = -1; // reset
         for(size_t i = 0; i < gaussians.size(); ++i) {
@@ -152,6 +162,9 @@ class ResponseCurve : public juce::Component {
     }
 
   private:
+    // The curve may also change from state restores, so work from a fresh copy per event.
+    void refreshPeaks() { gaussians = responseCurve.getGaussianPeaks(); }
+
     // ###################
     // #                 #
     // #  PAINT METHODS  #
@@ -170,14 +183,27 @@ class ResponseCurve : public juce::Component {
             float alpha = isSelected ? 0.4f : 0.205f;
             float strokeWidth = isSelected ? 2.5f : 2.0f;
 
+            // The peak sits on the baseline outside the columns it covers, so only those and
+            // one column either side are drawn
+            const auto [first, last]
+             = GaussianResponseCurve::getCoveredRange(gaussian, columnLogFrequencies);
+            const size_t begin = first > 0 ? first - 1 : 0;
+            const size_t end = std::min(last + 1, columnLogFrequencies.size());
+            if(end < begin + 2)
+                continue;
+
+            std::fill(columnValuesDB.begin() + (std::ptrdiff_t)begin,
+                      columnValuesDB.begin() + (std::ptrdiff_t)end, 0.0f);
+            GaussianResponseCurve::accumulatePeaks({&gaussian, 1}, columnLogFrequencies,
+                                                   columnValuesDB);
+
             juce::Path path;
-            for(int x = 0; x <= (int)bounds.getWidth(); ++x) {
-                float logFrequency = xToLogFrequency(bounds.getX() + x);
-                float gaussianValue = gaussianAtLogFrequency(logFrequency, gaussian);
-                float y = DBtoY(gaussianValue + responseCurveShiftDB);
-                if(x == 0 || x == (int)bounds.getWidth())
+            for(size_t x = begin; x < end; ++x) {
+                float y = DBtoY(columnValuesDB[x] + responseCurveShiftDB);
+                if(x == 0 || x == columnLogFrequencies.size() - 1)
                     y = DBtoY(responseCurveShiftDB);
-                x == 0 ? path.startNewSubPath(bounds.getX(), y) : path.lineTo(bounds.getX() + x, y);
+                const float columnX = bounds.getX() + (float)x;
+                x == begin ? path.startNewSubPath(columnX, y) : path.lineTo(columnX, y);
             }
 
             path.closeSubPath();
@@ -191,16 +217,15 @@ class ResponseCurve : public juce::Component {
 
     void drawSumOfGaussians(juce::Graphics &g) {
         auto bounds = getLocalBounds().toFloat();
+        std::fill(columnValuesDB.begin(), columnValuesDB.end(), 0.0f);
+        GaussianResponseCurve::accumulatePeaks(gaussians, columnLogFrequencies, columnValuesDB);
+
         juce::Path path;
-        for(int x = 0; x <= bounds.getWidth(); ++x) {
-            float sumDB = 0.0f;
-            float logFreq = xToLogFrequency(bounds.getX() + x);
-            for(const auto &gauss : gaussians) {
-                float gaussianValue = gaussianAtLogFrequency(logFreq, gauss);
-                sumDB += gaussianValue;
-            }
-            float y = DBtoY(sumDB + responseCurveShiftDB); // Add shift to value before converting
-            x == 0 ? path.startNewSubPath(bounds.getX(), y) : path.lineTo(bounds.getX() + x, y);
+        for(size_t x = 0; x < columnValuesDB.size(); ++x) {
+            // Add shift to value before converting
+            float y = DBtoY(columnValuesDB[x] + responseCurveShiftDB);
+            const float columnX = bounds.getX() + (float)x;
+            x == 0 ? path.startNewSubPath(columnX, y) : path.lineTo(columnX, y);
         }
         g.setColour(juce::Colours::yellow.withAlpha(0.8f).brighter());
         g.strokePath(path, juce::PathStrokeType(2.0f));
@@ -259,12 +284,14 @@ class ResponseCurve : public juce::Component {
                                  bounds.getRight());
     }
 
-    float gaussianAtLogFrequency(float logFrequency, const GaussianPeak &gaussian) const {
-        float peakLogFrequency = std::log10(gaussian.frequency);
-        float dx = logFrequency - peakLogFrequency;
-        float exponent = -0.5f * (dx * dx) / (gaussian.sigmaNorm * gaussian.sigmaNorm);
-        float gaussianLinear = std::exp(exponent);
-        return gaussian.gainDB * gaussianLinear;
+    // log10 frequency of every pixel column, evaluated by GaussianResponseCurve::accumulatePeaks
+    void updateColumnLogFrequencies() {
+        auto bounds = getLocalBounds().toFloat();
+        const size_t numColumns = (size_t)juce::jmax(0, (int)bounds.getWidth()) + 1;
+        columnLogFrequencies.resize(numColumns);
+        columnValuesDB.resize(numColumns);
+        for(size_t x = 0; x < numColumns; ++x)
+            columnLogFrequencies[x] = xToLogFrequency(bounds.getX() + (float)x);
     }
 
     juce::Colour getPeakColour(double frequency) const {
@@ -294,7 +321,9 @@ class ResponseCurve : public juce::Component {
     }
 
     GaussianResponseCurve &responseCurve;
-    std::vector<GaussianPeak> &gaussians;
+    GaussianResponseCurve::PeakList gaussians;
+    std::vector<float> columnLogFrequencies;
+    std::vector<float> columnValuesDB;
 
     int draggedPeakIndex = -1;
     int hoveredPeakIndex = -1; // -1 = no peak hovered
@@ -1,49 +1,60 @@
 #pragma once
 #include <JuceHeader.h>
 #include <cstddef>
-#include "FFTProcessor.h"
+#include "MultiResolutionProcessor.h"
 #include "juce_graphics/juce_graphics.h"
 #include "PluginParameters.h"
 #include "UIutils.h"
 
-template <int FFTSize> class SpectrumDisplay : public juce::Component, private juce::Timer {
+class SpectrumDisplay : public juce::Component, private juce::Timer {
   public:
-    SpectrumDisplay(FFTProcessor<FFTSize> &spectralProcessor, const double sampleRateHz,
+    SpectrumDisplay(MultiResolutionProcessor &spectralProcessor, const double sampleRateHz,
                     const juce::Colour spectrumColour, bool isDry = false)
         : processor(spectralProcessor), spectrumColour(spectrumColour), sampleRate(sampleRateHz),
           isDry(isDry) {
-        magnitudes.resize(processor.getProcessedMagnitudes().size(), -100.0f);
-        points.reserve(magnitudes.size() + 1); // Pre-allocate once
         startTimerHz(Parameters::FPS);
     }
 
     void paint(juce::Graphics &g) override {
-        const auto &newMagnitudes
-         = isDry ? processor.getUnprocessedMagnitudes() : processor.getProcessedMagnitudes();
-        if(newMagnitudes.empty())
+        if(sampleRate <= 0.0)
             return;
 
-        updateMagnitudes(newMagnitudes);
+        // Taken in while the engine cannot be replaced; the bin count follows the resolution
+        const bool hasFrame = processor.readActiveEngine([this](SpectralEngine &engine) {
+            const auto newMagnitudes
+             = isDry ? engine.getUnprocessedMagnitudes() : engine.getProcessedMagnitudes();
+            if(newMagnitudes.empty())
+                return false;
 
-        // Ensure binToX is valid
-        if(binToX.size() != magnitudes.size()) {
-            rebuildBinToX();
-            if(binToX.empty())
-                return; // Safety check
-        }
+            if(magnitudes.size() != newMagnitudes.size()) {
+                magnitudes.assign(newMagnitudes.size(), -100.0f);
+                points.reserve(magnitudes.size() + 1);
+            }
+
+            updateMagnitudes(newMagnitudes);
+            return true;
+        });
+        if(!hasFrame)
+            return;
+
+        // Shared with the engines: only fetched when the resolution or sample rate changes
+        if(binGeometry == nullptr || binGeometry->getNumBins() != magnitudes.size())
+            binGeometry = BinGeometry::get(sampleRate, (magnitudes.size() - 1) * 2);
 
         const auto bounds = getLocalBounds();
         const auto boundsBottom = static_cast<float>(bounds.getBottom());
         const auto boundsY = static_cast<float>(bounds.getY());
         const auto boundsX = static_cast<float>(bounds.getX());
+        const auto boundsWidth = static_cast<float>(bounds.getWidth());
+        const auto &displayPositions = binGeometry->displayPositions;
 
         juce::Path spectrumPath;
         points.clear();
         points.emplace_back(boundsX, boundsBottom);
 
-        // Build points using pre-calculated binToX
+        // Build points from the bins' precomputed display positions
         for(size_t i = 1; i < magnitudes.size(); ++i) {
-            const float x = binToX[i];
+            const float x = boundsX + displayPositions[i] * boundsWidth;
             float magnitudeDB = juce::jlimit(Parameters::minDBVisualizer,
                                              Parameters::maxDBVisualizer, magnitudes[i]);
             const float warpedDB = DBWarp(magnitudeDB);
@@ -84,11 +95,9 @@ template <int FFTSize> class SpectrumDisplay : public juce::Component, private j
 
     void setSampleRate(double newSampleRate) {
         sampleRate = newSampleRate;
-        rebuildBinToX();
+        binGeometry = nullptr;
     }
 
-    void resized() override { rebuildBinToX(); }
-
     void visibilityChanged() override {
         if(isVisible()) {
             startTimerHz(Parameters::FPS);
@@ -100,32 +109,6 @@ template <int FFTSize> class SpectrumDisplay : public juce::Component, private j
   protected:
     void timerCallback() override { repaint(); }
 
-    void rebuildBinToX() {
-        const auto b = getLocalBounds().toFloat();
-        if(b.getWidth() <= 0.0f || sampleRate <= 0.0) {
-            binToX.clear();
-            return;
-        }
-
-        const float nyquistFreq = static_cast<float>(sampleRate) * 0.5f;
-        const float minFreq = 20.0f;
-        const float logMin = std::log10(minFreq);
-        const float logMax = std::log10(nyquistFreq);
-        const float logRange = logMax - logMin;
-        const size_t n = magnitudes.size();
-        const float nyquistOverN = nyquistFreq / (n > 1 ? (n - 1) : 1);
-        const float boundsLeft = b.getX();
-        const float boundsWidth = b.getWidth();
-
-        binToX.resize(n);
-
-        for(size_t i = 0; i < n; ++i) {
-            const float frequency = i * nyquistOverN;
-            const float logFreq = std::log10(juce::jmax(minFreq, frequency));
-            binToX[i] = boundsLeft + ((logFreq - logMin) / logRange) * boundsWidth;
-        }
-    }
-
     void spectralSmoothing(std::vector<juce::Point<float>> &smoothPoints) {
         if(smoothPoints.size() < 3)
             return;
@@ -175,10 +158,11 @@ template <int FFTSize> class SpectrumDisplay : public juce::Component, private j
         }
     }
 
-    FFTProcessor<FFTSize> &processor;
+    MultiResolutionProcessor &processor;
+    MultiResolutionProcessor::AnalysisSubscription analysisSubscription{processor};
     std::vector<float> magnitudes;
     std::vector<juce::Point<float>> points; // Reused to avoid allocations
-    std::vector<float> binToX;
+    std::shared_ptr<const BinGeometry> binGeometry;
     double sampleRate;
     bool isDry;
     juce::Colour spectrumColour;
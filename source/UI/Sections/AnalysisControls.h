@@ -0,0 +1,94 @@
+#pragma once
+#include <JuceHeader.h>
+#include "PluginParameters.h"
+#include "UIutils.h"
+
+using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+
+class AnalysisSection : public juce::Component {
+  public:
+    AnalysisSection(AudioProcessorValueTreeState &apvts) : vts(apvts) {
+        // ######################
+        // #                    #
+        // #  SETUP COMBOBOXES  #
+        // #                    #
+        // ######################
+
+        StringArray resolutionItems;
+        for(auto size : Parameters::FFT_SIZES)
+            resolutionItems.add(String(size));
+        UIutils::setupComboBox(resolutionBox, resolutionItems, resolutionLabel, "Resolution");
+        addAndMakeVisible(resolutionBox);
+
+        StringArray overlapItems;
+        for(auto factor : Parameters::OVERLAP_FACTORS)
+            overlapItems.add(String(factor) + "x");
+        UIutils::setupComboBox(overlapBox, overlapItems, overlapLabel, "Overlap");
+        addAndMakeVisible(overlapBox);
+
+        UIutils::setupComboBox(linkBox, {"Off", "Groups", "All"}, linkLabel, "Link");
+        addAndMakeVisible(linkBox);
+
+        UIutils::setupComboBox(detectionBox, {"Bins", "ERB", "Bark", "1/3 Oct", "1/6 Oct"},
+                               detectionLabel, "Detect");
+        addAndMakeVisible(detectionBox);
+
+        // ########################
+        // #                      #
+        // #  SETUP ATTACHEMENTS  #
+        // #                      #
+        // ########################
+
+        resolutionAttachment.reset(
+         new ComboBoxAttachment(vts, Parameters::resolutionID, resolutionBox));
+        overlapAttachment.reset(new ComboBoxAttachment(vts, Parameters::overlapID, overlapBox));
+        linkAttachment.reset(new ComboBoxAttachment(vts, Parameters::channelLinkID, linkBox));
+        detectionAttachment.reset(
+         new ComboBoxAttachment(vts, Parameters::detectionScaleID, detectionBox));
+    }
+
+    ~AnalysisSection() override {
+        resolutionAttachment.reset();
+        overlapAttachment.reset();
+        linkAttachment.reset();
+        detectionAttachment.reset();
+    }
+
+    // Room for every combo box at its preferred width, each with its label to the left
+    static constexpr int getPreferredWidth() { return NUM_CONTROLS * (LABEL_WIDTH + BOX_WIDTH); }
+
+    void resized() override {
+        auto bounds = getLocalBounds();
+        const std::array<ComboBox *, NUM_CONTROLS> boxes{&resolutionBox, &overlapBox, &linkBox,
+                                                         &detectionBox};
+
+        // Equal shares of whatever width the editor gives, the last one taking the remainder
+        for(int i = 0; i < NUM_CONTROLS; ++i) {
+            auto controlBounds = bounds.removeFromLeft(bounds.getWidth() / (NUM_CONTROLS - i));
+            boxes[(size_t)i]->setBounds(controlBounds.withTrimmedLeft(LABEL_WIDTH).reduced(0, 5));
+        }
+    }
+
+  private:
+    static constexpr int NUM_CONTROLS = 4;
+    static constexpr int LABEL_WIDTH = 80;
+    static constexpr int BOX_WIDTH = 135;
+
+    AudioProcessorValueTreeState &vts;
+
+    ComboBox resolutionBox;
+    Label resolutionLabel;
+    ComboBox overlapBox;
+    Label overlapLabel;
+    ComboBox linkBox;
+    Label linkLabel;
+    ComboBox detectionBox;
+    Label detectionLabel;
+
+    std::unique_ptr<ComboBoxAttachment> resolutionAttachment;
+    std::unique_ptr<ComboBoxAttachment> overlapAttachment;
+    std::unique_ptr<ComboBoxAttachment> linkAttachment;
+    std::unique_ptr<ComboBoxAttachment> detectionAttachment;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisSection)
+};
@@ -37,6 +37,13 @@ class CompressorSection : public juce::Component {
         addAndMakeVisible(releaseSlider);
         addAndMakeVisible(releaseLabel);
 
+        UIutils::setupSlider(timeTiltSlider, juce::Slider::RotaryHorizontalVerticalDrag,
+                             Parameters::minTimeTilt, Parameters::maxTimeTilt,
+                             Parameters::defaultTimeTilt, Parameters::stepSizeTimeTilt, "x/oct",
+                             Parameters::skewFactorTimeTilt, timeTiltLabel, "Time Tilt");
+        addAndMakeVisible(timeTiltSlider);
+        addAndMakeVisible(timeTiltLabel);
+
         UIutils::setupSlider(curveShiftSlider, juce::Slider::RotaryHorizontalVerticalDrag,
                              Parameters::minCurveShift, Parameters::maxCurveShift,
                              Parameters::defaultCurveShiftDB, Parameters::stepSizeCurveShift, " dB",
@@ -66,6 +73,9 @@ class CompressorSection : public juce::Component {
         // #                 #
         // ###################
 
+        UIutils::setupToggleButton(autoReleaseButton, "Auto");
+        addAndMakeVisible(autoReleaseButton);
+
         // ########################
         // #                      #
         // #  SETUP ATTACHEMENTS  #
@@ -76,18 +86,23 @@ class CompressorSection : public juce::Component {
          new SliderAttachment(vts, Parameters::attackTimeID, attackSlider));
         outputGainAttachment.reset(
          new SliderAttachment(vts, Parameters::releaseTimeID, releaseSlider));
+        timeTiltAttachment.reset(new SliderAttachment(vts, Parameters::timeTiltID, timeTiltSlider));
         thresholdAttachment.reset(
          new SliderAttachment(vts, Parameters::curveShiftDBID, curveShiftSlider));
         ratioAttachment.reset(new SliderAttachment(vts, Parameters::ratioID, ratioSlider));
         kneeAttachment.reset(new SliderAttachment(vts, Parameters::kneeWidthID, kneeSlider));
+        autoReleaseAttachment.reset(
+         new ButtonAttachment(vts, Parameters::autoReleaseID, autoReleaseButton));
     }
 
     ~CompressorSection() override {
         inputGainAttachment.reset();
         outputGainAttachment.reset();
+        timeTiltAttachment.reset();
         thresholdAttachment.reset();
         ratioAttachment.reset();
         kneeAttachment.reset();
+        autoReleaseAttachment.reset();
     }
 
     void resized() override {
@@ -96,15 +111,19 @@ class CompressorSection : public juce::Component {
 
         bounds.reduce(30, 30);
 
-        auto knobWidth = bounds.getWidth() / 5;
+        auto knobWidth = bounds.getWidth() / 6;
         attackSlider.setBounds(bounds.removeFromLeft(knobWidth).reduced(5));
-        releaseSlider.setBounds(bounds.removeFromLeft(knobWidth).reduced(5));
+        auto releaseBounds = bounds.removeFromLeft(knobWidth);
+        autoReleaseButton.setBounds(releaseBounds.removeFromBottom(24).reduced(5, 0));
+        releaseSlider.setBounds(releaseBounds.reduced(5));
+        timeTiltSlider.setBounds(bounds.removeFromLeft(knobWidth).reduced(5));
         curveShiftSlider.setBounds(bounds.removeFromLeft(knobWidth).reduced(5));
         ratioSlider.setBounds(bounds.removeFromLeft(knobWidth).reduced(5));
         kneeSlider.setBounds(bounds.reduced(5));
 
         UIutils::attachLabel(attackLabel, &attackSlider);
         UIutils::attachLabel(releaseLabel, &releaseSlider);
+        UIutils::attachLabel(timeTiltLabel, &timeTiltSlider);
         UIutils::attachLabel(thresholdLabel, &curveShiftSlider);
         UIutils::attachLabel(ratioLabel, &ratioSlider);
         UIutils::attachLabel(kneeLabel, &kneeSlider);
@@ -113,6 +132,9 @@ class CompressorSection : public juce::Component {
     void updateEnabled() {
         attackSlider.setEnabled(*vts.getRawParameterValue(Parameters::compressorModeID) < 2);
         releaseSlider.setEnabled(*vts.getRawParameterValue(Parameters::compressorModeID) < 2);
+        timeTiltSlider.setEnabled(*vts.getRawParameterValue(Parameters::compressorModeID) < 2);
+        // Only the compressor releases automatically
+        autoReleaseButton.setEnabled(*vts.getRawParameterValue(Parameters::compressorModeID) == 0);
         kneeSlider.setEnabled(*vts.getRawParameterValue(Parameters::compressorModeID) < 2);
         ratioSlider.setEnabled(*vts.getRawParameterValue(Parameters::compressorModeID) < 2);
     }
@@ -123,21 +145,26 @@ class CompressorSection : public juce::Component {
 
     Slider attackSlider;
     Slider releaseSlider;
+    Slider timeTiltSlider;
     Slider curveShiftSlider;
     Slider ratioSlider;
     Slider kneeSlider;
+    juce::ToggleButton autoReleaseButton;
 
     Label attackLabel;
     Label releaseLabel;
+    Label timeTiltLabel;
     Label thresholdLabel;
     Label ratioLabel;
     Label kneeLabel;
 
     std::unique_ptr<SliderAttachment> inputGainAttachment;
     std::unique_ptr<SliderAttachment> outputGainAttachment;
+    std::unique_ptr<SliderAttachment> timeTiltAttachment;
     std::unique_ptr<SliderAttachment> thresholdAttachment;
     std::unique_ptr<SliderAttachment> ratioAttachment;
     std::unique_ptr<SliderAttachment> kneeAttachment;
+    std::unique_ptr<ButtonAttachment> autoReleaseAttachment;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CompressorSection)
 };
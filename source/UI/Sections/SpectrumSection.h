@@ -48,9 +48,9 @@ class SpectrumSection : public juce::Component {
 
   private:
     SpectrixAudioProcessor &audioProcessor;
-    SpectrumDisplay<Parameters::FFT_SIZE> spectrumDisplay;
-    SpectralGainReductionVisualizer<Parameters::FFT_SIZE> gainReductionVisualizer;
-    SpectrumDisplay<Parameters::FFT_SIZE> drySpectrum;
+    SpectrumDisplay spectrumDisplay;
+    SpectralGainReductionVisualizer gainReductionVisualizer;
+    SpectrumDisplay drySpectrum;
     ResponseCurve responseCurve;
     SpectrumGrid grid;
 
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+
+// Alignment that keeps data written by different threads off each other's cache lines. 64 bytes
+// is the line size of x86 and most ARM cores.
+inline constexpr size_t CACHE_LINE_SIZE = 64;
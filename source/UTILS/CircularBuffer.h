@@ -1,47 +1,105 @@
 #pragma once
 #include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <span>
 
+// Fixed-capacity FIFO with a power-of-two size and a mirrored backing store: every sample is
+// written twice, SIZE apart, so any run of up to SIZE buffered samples is contiguous in memory and
+// can be handed out as a span without wrapping. Indices wrap with a mask instead of a modulo.
 template <typename TYPE, size_t SIZE> class CircularBuffer {
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "CircularBuffer SIZE must be a power of 2");
+
   public:
-    CircularBuffer() : writeIndex(0), readIndex(0), count(0) {}
+    CircularBuffer() { clear(); }
 
-    void push(float sample) {
+    void push(TYPE sample) {
         buffer[writeIndex] = sample;
-        writeIndex = (writeIndex + 1) % SIZE;
+        buffer[writeIndex + SIZE] = sample;
+        writeIndex = (writeIndex + 1) & MASK;
 
         if(count < SIZE)
             ++count;
         else
-            readIndex = (readIndex + 1) % SIZE;
+            readIndex = (readIndex + 1) & MASK;
     }
 
-    float pop() {
+    TYPE pop() {
         if(count == 0)
-            return 0.0f; // empty
+            return TYPE(0); // empty
 
-        float sample = buffer[readIndex];
-        readIndex = (readIndex + 1) % SIZE;
+        TYPE sample = buffer[readIndex];
+        readIndex = (readIndex + 1) & MASK;
         --count;
         return sample;
     }
 
-    float operator[](size_t index) const {
+    // Bulk push of a contiguous run; oldest samples are overwritten once the buffer is full.
+    void push(const TYPE *samples, size_t numSamples) {
+        if(numSamples >= SIZE) {
+            samples += numSamples - SIZE;
+            numSamples = SIZE;
+        }
+
+        const size_t firstPart = std::min(numSamples, SIZE - writeIndex);
+        writeMirrored(samples, firstPart, writeIndex);
+        writeMirrored(samples + firstPart, numSamples - firstPart, 0);
+        writeIndex = (writeIndex + numSamples) & MASK;
+
+        if(count + numSamples > SIZE) {
+            count = SIZE;
+            readIndex = writeIndex;
+        } else {
+            count += numSamples;
+        }
+    }
+
+    // Bulk pop into a contiguous run; samples beyond the buffered ones are zero, as with pop().
+    void pop(TYPE *destination, size_t numSamples) {
+        const size_t available = std::min(numSamples, count);
+        std::copy_n(buffer.begin() + readIndex, available, destination);
+        std::fill(destination + available, destination + numSamples, TYPE(0));
+        discard(available);
+    }
+
+    // Drops the oldest numSamples without reading them.
+    void discard(size_t numSamples) {
+        numSamples = std::min(numSamples, count);
+        readIndex = (readIndex + numSamples) & MASK;
+        count -= numSamples;
+    }
+
+    // The most recently pushed numSamples, oldest first, as one contiguous view.
+    std::span<const TYPE> latest(size_t numSamples) const {
+        jassert(numSamples <= count);
+        return {buffer.data() + ((writeIndex - numSamples) & MASK), numSamples};
+    }
+
+    TYPE operator[](size_t index) const {
         jassert(index < count);
-        return buffer[(readIndex + index) % SIZE];
+        return buffer[(readIndex + index) & MASK];
     }
+
     void clear() {
         writeIndex = 0;
         readIndex = 0;
         count = 0;
-        buffer.fill(0);
+        buffer.fill(TYPE(0));
     }
 
-    float getFirstElement() const { return buffer[readIndex]; }
+    TYPE getFirstElement() const { return buffer[readIndex]; }
 
     size_t size() const { return count; }
 
   private:
-    std::array<TYPE, SIZE> buffer;
+    static constexpr size_t MASK = SIZE - 1;
+
+    void writeMirrored(const TYPE *samples, size_t numSamples, size_t index) {
+        std::copy_n(samples, numSamples, buffer.begin() + index);
+        std::copy_n(samples, numSamples, buffer.begin() + index + SIZE);
+    }
+
+    std::array<TYPE, SIZE * 2> buffer;
     size_t writeIndex;
     size_t readIndex;
     size_t count;
@@ -0,0 +1,40 @@
+#pragma once
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Process-wide cache of immutable tables of one type, such as windows and FFT twiddles, so every
+// plugin instance using the same configuration shares a single copy. The cache holds only weak
+// references: a table lives as long as some instance uses it, and is rebuilt the next time it is
+// needed after the last one let go.
+//
+// get() locks and may allocate, so call it when preparing, never on the audio thread.
+template <typename TABLE, typename KEY> class SharedTables {
+  public:
+    // The table for key, built with build() if no live instance exists.
+    template <typename BUILD>
+    static std::shared_ptr<const TABLE> get(const KEY &key, BUILD &&build) {
+        auto &cache = getCache();
+        const std::lock_guard<std::mutex> lock(cache.mutex);
+
+        auto &entry = cache.tables[key];
+        if(auto table = entry.lock())
+            return table;
+
+        std::shared_ptr<const TABLE> table = build();
+        entry = table;
+        return table;
+    }
+
+  private:
+    struct Cache {
+        std::mutex mutex;
+        std::map<KEY, std::weak_ptr<const TABLE>> tables;
+    };
+
+    static Cache &getCache() {
+        static Cache cache;
+        return cache;
+    }
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "CacheLine.h"
+
+// Wait-free single-producer/single-consumer snapshot channel. The producer fills the back slot and
+// publishes it with one atomic exchange against the shared middle slot; the consumer swaps the
+// middle slot into the front only when a new one was published. Neither side ever blocks, and the
+// consumer always sees a complete frame that the producer will not touch until the next read.
+//
+// The producer and consumer run on different threads, so each slot, the shared index and each
+// side's own index sit on cache lines of their own: writing one never invalidates the other's.
+template <typename TYPE> class TripleBuffer {
+  public:
+    TripleBuffer() {
+        for(auto &slot : slots)
+            slot.value = TYPE{};
+    }
+
+    // Producer side: the slot to fill before publish().
+    TYPE &write() { return slots[backIndex].value; }
+
+    void publish() {
+        backIndex = middle.exchange(backIndex | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Consumer side: the newest published slot, stable until the next call to read().
+    const TYPE &read() {
+        if(middle.load(std::memory_order_relaxed) & DIRTY)
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return slots[frontIndex].value;
+    }
+
+  private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        TYPE value;
+    };
+
+    std::array<Slot, 3> slots;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint8_t> middle{1};
+    alignas(CACHE_LINE_SIZE) uint8_t backIndex = 0;  // producer only
+    alignas(CACHE_LINE_SIZE) uint8_t frontIndex = 2; // consumer only
+
+    JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+};
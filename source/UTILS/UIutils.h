@@ -34,6 +34,16 @@ namespace UIutils {
         button.setToggleState(false, juce::dontSendNotification);
     }
 
+    inline void setupComboBox(juce::ComboBox &comboBox, const juce::StringArray &items,
+                              juce::Label &label, const juce::String &labelText) {
+        comboBox.addItemList(items, 1);
+        comboBox.setJustificationType(juce::Justification::centred);
+
+        label.setText(labelText, juce::dontSendNotification);
+        label.setJustificationType(juce::Justification::centredRight);
+        label.attachToComponent(&comboBox, true);
+    }
+
 }
 static const float minDB = Parameters::minDBVisualizer;
 static const float maxDB = Parameters::maxDBVisualizer;
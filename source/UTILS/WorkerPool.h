@@ -0,0 +1,138 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of threads that share the indexed tasks of one run() with the calling thread. Every
+// participant claims the next unstarted index from a shared counter, so a thread that finishes
+// early keeps pulling work instead of idling behind a slow one. run() returns only once all tasks
+// have completed, which gives its caller a deterministic join point.
+//
+// Workers sleep on a condition variable between runs, so this is meant for offline rendering,
+// not for the real-time audio thread.
+class WorkerPool {
+  public:
+    explicit WorkerPool(int numWorkers) {
+        threads.reserve((size_t)numWorkers);
+        for(int i = 0; i < numWorkers; ++i)
+            threads.emplace_back([this] { workerLoop(); });
+    }
+
+    ~WorkerPool() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeWorkers.notify_all();
+
+        for(auto &thread : threads)
+            thread.join();
+    }
+
+    // Threads available to a run, including the caller.
+    int getConcurrency() const { return (int)threads.size() + 1; }
+
+    // Calls task(index) for every index in [0, numTasks). Not reentrant: one run at a time.
+    template <typename TASK> void run(int numTasks, TASK &&task) {
+        if(numTasks <= 0)
+            return;
+
+        if(numTasks == 1 || threads.empty()) {
+            for(int index = 0; index < numTasks; ++index)
+                task(index);
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            using Callable = std::remove_reference_t<TASK>;
+            job = {(void *)&task,
+                   [](void *context, int index) { (*static_cast<Callable *>(context))(index); },
+                   numTasks};
+            nextTask.store(0, std::memory_order_relaxed);
+            remainingTasks.store(numTasks, std::memory_order_relaxed);
+            ++generation;
+            jobOpen = true;
+        }
+        wakeWorkers.notify_all();
+
+        runTasks(job);
+
+        // Close the job only once no worker can still claim an index of it
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [this] {
+            return remainingTasks.load(std::memory_order_acquire) == 0 && activeWorkers == 0;
+        });
+        jobOpen = false;
+    }
+
+  private:
+    struct Job {
+        void *context = nullptr;
+        void (*invoke)(void *, int) = nullptr;
+        int numTasks = 0;
+    };
+
+    void workerLoop() {
+        uint64_t seenGeneration = 0;
+        for(;;) {
+            Job current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeWorkers.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if(stopping)
+                    return;
+
+                // A worker waking after the job was closed has nothing left to join
+                seenGeneration = generation;
+                if(!jobOpen)
+                    continue;
+
+                current = job;
+                ++activeWorkers;
+            }
+
+            runTasks(current);
+
+            const std::lock_guard<std::mutex> lock(mutex);
+            if(--activeWorkers == 0)
+                jobDone.notify_all();
+        }
+    }
+
+    void runTasks(const Job &current) {
+        for(;;) {
+            const int index = nextTask.fetch_add(1, std::memory_order_relaxed);
+            if(index >= current.numTasks)
+                return;
+
+            current.invoke(current.context, index);
+
+            if(remainingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                jobDone.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobDone;
+    Job job;
+    uint64_t generation = 0;
+    int activeWorkers = 0;
+    bool jobOpen = false;
+    bool stopping = false;
+
+    std::atomic<int> nextTask{0};
+    std::atomic<int> remainingTasks{0};
+
+    JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+};
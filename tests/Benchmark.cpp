@@ -0,0 +1,757 @@
+#include <JuceHeader.h>
+#include "CircularBuffer.h"
+#include "FFTBackend.h"
+#include "MultiResolutionProcessor.h"
+#include "SpectralCompressor.h"
+#include "TripleBuffer.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Timings of the engine at the settings each optimisation targets. The numbers depend on the
+// machine and its load, so this only prints them and is not registered with ctest. Build it in
+// Release and compare runs on the same machine.
+
+// Every allocation in the process is counted, so the instance section can report what creating
+// one costs in memory. Counting is all these add to the default allocation functions.
+namespace {
+    std::atomic<size_t> allocatedBytes{0};
+} // namespace
+
+void *operator new(size_t size) {
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if(void *memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+// Over-allocated by the alignment, with the block's own address kept just below the result.
+// malloc aligns to at least a pointer, so there is always room for it.
+void *operator new(size_t size, std::align_val_t alignment) {
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    const auto align = std::max((size_t)alignment, sizeof(void *));
+    auto *block = static_cast<char *>(std::malloc(size + align));
+    if(block == nullptr)
+        throw std::bad_alloc();
+    auto *aligned = block + align - reinterpret_cast<uintptr_t>(block) % align;
+    reinterpret_cast<void **>(aligned)[-1] = block;
+    return aligned;
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, size_t) noexcept { std::free(memory); }
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    if(memory != nullptr)
+        std::free(static_cast<void **>(memory)[-1]);
+}
+
+void operator delete(void *memory, size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+namespace {
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int NUM_CHANNELS = 2;
+    constexpr double SECONDS = 4.0;
+    constexpr int REPETITIONS = 7; // the fastest run counts, as the least disturbed one
+
+    std::atomic<float> mode{COMPRESSOR}, attackMs{5.0f}, releaseMs{50.0f}, ratio{4.0f},
+     kneeDB{6.0f};
+    constexpr const char *modeNames[] = {"compressor", "expander", "clipper", "gate"};
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    struct Timing {
+        double realTimeFraction = 0.0; // processing time per second of audio
+        double idleNanoseconds = 0.0;  // per sample frame, over the blocks that complete no frame
+    };
+
+    struct EngineSettings {
+        int blockSize = 512;
+        int overlap = 4;
+        bool analysis = false;
+        bool displayReader = false; // a thread polling the snapshots while the engine runs
+        double silentFraction = 0.0; // of every second, at its end
+        WorkerPool *workerPool = nullptr;
+        ChannelLink link = UNLINKED;
+        ChannelGroups layoutGroups; // linked together under LINK_GROUPS
+    };
+
+    std::atomic<float> readerSink{0.0f}; // keeps the reader's loads from being optimised away
+
+    // Noise through a fresh engine per repetition, with the analysis off unless asked for
+    template <size_t FFT_SIZE, int CHANNELS = NUM_CHANNELS>
+    Timing measureEngine(const EngineSettings &settings) {
+        const int blockSize = settings.blockSize;
+        const int numSamples = (int)(SAMPLE_RATE * SECONDS) / blockSize * blockSize;
+        const int soundingSamples = (int)(SAMPLE_RATE * (1.0 - settings.silentFraction));
+        juce::Random random(1);
+        juce::AudioBuffer<float> input(CHANNELS, numSamples);
+        for(int ch = 0; ch < CHANNELS; ++ch)
+            for(int i = 0; i < numSamples; ++i)
+                input.getWritePointer(ch)[i] = (i % (int)SAMPLE_RATE < soundingSamples)
+                                                ? 0.5f * (random.nextFloat() - 0.5f)
+                                                : 0.0f;
+
+        GaussianResponseCurve responseCurve;
+        responseCurve.addPeak({1000.0f, -30.0f, 0.3f});
+        responseCurve.addPeak({5000.0f, -40.0f, 0.1f});
+
+        const std::atomic<float> channelLink{(float)settings.link};
+
+        Timing best{1e30, 1e30};
+        juce::AudioBuffer<float> block(CHANNELS, blockSize);
+        for(int repetition = 0; repetition < REPETITIONS; ++repetition) {
+            auto engine = std::make_unique<SpectralDynamicsProcessor<FFT_SIZE, (size_t)CHANNELS>>(
+             responseCurve);
+            engine->setParameterSource(
+             {&mode, &attackMs, &releaseMs, &ratio, &kneeDB, &channelLink});
+            engine->setLayoutGroups(settings.layoutGroups);
+            engine->setWorkerPool(settings.workerPool);
+            engine->prepareToPlay(SAMPLE_RATE, (size_t)settings.overlap);
+            engine->setAnalysisEnabled(settings.analysis);
+
+            // Frames complete at FFT_SIZE - 1 and every hop after it
+            const int hop = (int)engine->getHopSize();
+            auto completesFrame = [&](int begin, int end) {
+                const int last = end - 1 - ((end - (int)FFT_SIZE) % hop + hop) % hop;
+                return last >= begin && last >= (int)FFT_SIZE - 1;
+            };
+
+            // Reads every bin of every snapshot as fast as it can, a worst case for the displays
+            std::atomic<bool> reading{settings.displayReader};
+            std::thread reader;
+            if(settings.displayReader)
+                reader = std::thread([&] {
+                    float sum = 0.0f;
+                    while(reading.load(std::memory_order_relaxed))
+                        for(const auto snapshot :
+                            {engine->getProcessedMagnitudes(), engine->getUnprocessedMagnitudes(),
+                             engine->getGainReductionArray()})
+                            for(const float value : snapshot)
+                                sum += value;
+                    readerSink.store(sum, std::memory_order_relaxed);
+                });
+
+            double total = 0.0, idle = 0.0;
+            int idleSamples = 0;
+            for(int position = 0; position < numSamples; position += blockSize) {
+                for(int ch = 0; ch < CHANNELS; ++ch)
+                    block.copyFrom(ch, 0, input, ch, position, blockSize);
+
+                const auto start = Clock::now();
+                engine->processBlock(block);
+                const double elapsed = secondsSince(start);
+
+                total += elapsed;
+                if(!completesFrame(position, position + blockSize)) {
+                    idle += elapsed;
+                    idleSamples += blockSize;
+                }
+            }
+
+            reading.store(false, std::memory_order_relaxed);
+            if(reader.joinable())
+                reader.join();
+
+            best.realTimeFraction
+             = std::min(best.realTimeFraction, total * SAMPLE_RATE / numSamples);
+            if(idleSamples > 0)
+                best.idleNanoseconds = std::min(best.idleNanoseconds, idle * 1e9 / idleSamples);
+        }
+        return best;
+    }
+} // namespace
+
+// Runs the bin stages of SpectralDynamicsProcessor::processFFTBins on one channel's frame, or the
+// per-bin code they replaced on the same spectrum. A friend of the engine, like the accuracy
+// test, so the stages are timed on their own rather than behind the transforms.
+class SpectralDynamicsBenchmark {
+  public:
+    enum BinLoop {
+        POLAR,       // per bin: magnitude and atan2, std::log10, branches, then cos and sin
+        RECTANGULAR, // the same, with the gain scaling the real and imaginary parts instead
+        KERNEL,      // the engine's stages, each a branchless loop over all bins
+        SWITCHED     // the same stages with the mode switched per bin, as before they were split
+    };
+
+    // Nanoseconds per frame, with the envelopes settled by a second of noise
+    template <size_t FFT_SIZE>
+    static double timeBinLoop(BinLoop binLoop, CompressorMode compressorMode = COMPRESSOR,
+                              bool autoRelease = false) {
+        using Engine = SpectralDynamicsProcessor<FFT_SIZE, 1>;
+        using Buffer = std::array<float, FFT_SIZE * 2>;
+        constexpr size_t NUM_FRAMES = ((size_t)1 << 22) / FFT_SIZE;
+
+        GaussianResponseCurve responseCurve;
+        responseCurve.addPeak({1000.0f, -30.0f, 0.3f});
+        responseCurve.addPeak({5000.0f, -40.0f, 0.1f});
+        const std::atomic<float> autoReleaseOn{autoRelease ? 1.0f : 0.0f};
+        auto engine = std::make_unique<Engine>(responseCurve);
+        engine->setParameterSource({.compressorMode = &mode,
+                                    .attackTimeMs = &attackMs,
+                                    .releaseTimeMs = &releaseMs,
+                                    .ratio = &ratio,
+                                    .kneeDB = &kneeDB,
+                                    .autoRelease = &autoReleaseOn});
+        engine->prepareToPlay(SAMPLE_RATE, 4);
+
+        // Latches the hop's settings and thresholds
+        juce::Random random(1);
+        juce::AudioBuffer<float> noise(1, (int)SAMPLE_RATE);
+        for(int i = 0; i < noise.getNumSamples(); ++i)
+            noise.getWritePointer(0)[i] = 0.5f * (random.nextFloat() - 0.5f);
+        engine->processBlock(noise);
+        engine->mode = compressorMode;
+        auto &state = engine->channelStates[0];
+
+        // Every frame starts from the same spectrum of that noise, so each sees the same levels
+        auto spectrum = std::make_unique<Buffer>();
+        auto buffer = std::make_unique<Buffer>();
+        std::copy(noise.getReadPointer(0), noise.getReadPointer(0) + FFT_SIZE, spectrum->begin());
+        RealFFT<FFT_SIZE>().forward(spectrum->data());
+
+        double best = 1e30;
+        float sink = 0.0f;
+        for(int repetition = 0; repetition < REPETITIONS; ++repetition) {
+            const auto start = Clock::now();
+            for(size_t frame = 0; frame < NUM_FRAMES; ++frame) {
+                std::copy(spectrum->begin(), spectrum->begin() + 2 * Engine::NUM_BINS,
+                          buffer->begin());
+                switch(binLoop) {
+                case POLAR: runPolar(*engine, state, *buffer); break;
+                case RECTANGULAR: runRectangular(*engine, state, *buffer); break;
+                case KERNEL: runKernel(*engine, state, *buffer); break;
+                case SWITCHED: runSwitched(*engine, state, *buffer); break;
+                }
+                sink += (*buffer)[frame % FFT_SIZE];
+            }
+            best = std::min(best, secondsSince(start));
+        }
+        // Keeps the frames observable so the loops are not optimised away
+        if(sink == 0.0f)
+            std::printf(" ");
+        return best * 1e9 / NUM_FRAMES;
+    }
+
+  private:
+    static constexpr float MIN_MAGNITUDE = 1e-10f;
+
+    // The gain computer as it ran per bin: the mode switch, the knee's branches and the envelope
+    template <typename Engine>
+    static float referenceReduction(Engine &engine, typename Engine::ChannelState &state,
+                                    size_t bin, float levelDB) {
+        const float overDB
+         = levelDB - (engine.hopThresholds->thresholdsDB[bin] + engine.hopShiftDB);
+        const float kneeDB = engine.hopKneeDB;
+        auto curve = [&] {
+            if(overDB <= -kneeDB / 2.0f)
+                return 0.0f;
+            if(overDB >= kneeDB / 2.0f)
+                return overDB * engine.hopSlope;
+            const float kneePosition = overDB + kneeDB / 2.0f;
+            return kneePosition * kneePosition / (2.0f * kneeDB) * engine.hopSlope;
+        };
+
+        float targetDB;
+        switch(engine.mode) {
+        case COMPRESSOR: targetDB = curve(); break;
+        case EXPANDER: targetDB = -curve(); break;
+        case CLIPPER: return std::max(overDB, 0.0f);
+        default: targetDB = (overDB < 0.0f) ? Engine::GATE_REDUCTION_DB : 0.0f; break;
+        }
+
+        float &envelope = state.envelopeFollowers[bin];
+        const float coeff
+         = (targetDB > envelope) ? engine.attackCoeffs[bin] : engine.releaseCoeffs[bin];
+        envelope = coeff * envelope + (1.0f - coeff) * targetDB;
+        return envelope;
+    }
+
+    // What processFFTBins runs for one unlinked channel detected per bin
+    template <typename Engine, typename Buffer>
+    static void runKernel(Engine &engine, typename Engine::ChannelState &state, Buffer &buffer) {
+        constexpr size_t NUM_BINS = Engine::NUM_BINS;
+        engine.computeLevels(state, buffer, 0, NUM_BINS);
+        engine.computeGainReduction(
+         state.levelsDB, engine.hopThresholds->thresholdsDB, state.envelopeFollowers,
+         state.slowEnvelopes, state.gainReductionsDB,
+         {engine.attackCoeffs.data(), engine.releaseCoeffs.data(), engine.slowCoeffs.data()}, 0,
+         NUM_BINS);
+        Engine::computeGains(state.gainReductionsDB, state.gains, 0, NUM_BINS);
+        Engine::applyGains(state, buffer, 0, NUM_BINS);
+    }
+
+    // runKernel with the gain computer's mode read and switched on inside the bin loop
+    template <typename Engine, typename Buffer>
+    static void runSwitched(Engine &engine, typename Engine::ChannelState &state,
+                            Buffer &buffer) {
+        constexpr size_t NUM_BINS = Engine::NUM_BINS;
+        engine.computeLevels(state, buffer, 0, NUM_BINS);
+
+        const float kneeDB = engine.hopKneeDB;
+        const float slope = engine.hopSlope;
+        const float halfKnee = kneeDB * 0.5f;
+        const float inverseTwoKnee = (kneeDB > 0.0f) ? 1.0f / (2.0f * kneeDB) : 0.0f;
+        auto staticCurve = [=](float overDB) {
+            const float inKnee = std::clamp(overDB + halfKnee, 0.0f, kneeDB);
+            return (inKnee * inKnee * inverseTwoKnee + std::max(overDB - halfKnee, 0.0f)) * slope;
+        };
+
+        const auto &thresholdsDB = engine.hopThresholds->thresholdsDB;
+        for(size_t bin = 0; bin < NUM_BINS; ++bin) {
+            const float overDB = state.levelsDB[bin] - (thresholdsDB[bin] + engine.hopShiftDB);
+
+            float targetDB;
+            switch(engine.mode) {
+            case COMPRESSOR: targetDB = staticCurve(overDB); break;
+            case EXPANDER: targetDB = -staticCurve(overDB); break;
+            case CLIPPER: targetDB = std::max(overDB, 0.0f); break;
+            default: targetDB = (overDB < 0.0f) ? Engine::GATE_REDUCTION_DB : 0.0f; break;
+            }
+
+            if(engine.mode == CLIPPER) {
+                state.gainReductionsDB[bin] = targetDB;
+                continue;
+            }
+
+            const float envelope = state.envelopeFollowers[bin];
+            const float coeff
+             = (targetDB > envelope) ? engine.attackCoeffs[bin] : engine.releaseCoeffs[bin];
+            const float smoothed = coeff * envelope + (1.0f - coeff) * targetDB;
+            state.envelopeFollowers[bin] = smoothed;
+            state.gainReductionsDB[bin] = smoothed;
+        }
+
+        Engine::computeGains(state.gainReductionsDB, state.gains, 0, NUM_BINS);
+        Engine::applyGains(state, buffer, 0, NUM_BINS);
+    }
+
+    template <typename Engine, typename Buffer>
+    static void runPolar(Engine &engine, typename Engine::ChannelState &state, Buffer &buffer) {
+        for(size_t bin = 0; bin < Engine::NUM_BINS; ++bin) {
+            const bool edge = bin == 0 || bin == Engine::NUM_BINS - 1;
+            const float binScale = edge ? engine.dcNyquistScale : engine.scale;
+            const float real = buffer[2 * bin], imag = buffer[2 * bin + 1];
+            float magnitude = std::sqrt(real * real + imag * imag) * binScale;
+            const float phase = std::atan2(imag, real);
+
+            const float levelDB = (magnitude > MIN_MAGNITUDE) ? 20.0f * std::log10(magnitude)
+                                                              : Engine::MIN_MAGNITUDE_DB;
+            const float reductionDB = referenceReduction(engine, state, bin, levelDB);
+            state.gainReductionsDB[bin] = reductionDB;
+
+            magnitude *= juce::Decibels::decibelsToGain(-reductionDB) / binScale;
+            buffer[2 * bin] = magnitude * std::cos(phase);
+            buffer[2 * bin + 1] = magnitude * std::sin(phase);
+        }
+    }
+
+    template <typename Engine, typename Buffer>
+    static void runRectangular(Engine &engine, typename Engine::ChannelState &state,
+                               Buffer &buffer) {
+        for(size_t bin = 0; bin < Engine::NUM_BINS; ++bin) {
+            const bool edge = bin == 0 || bin == Engine::NUM_BINS - 1;
+            const float binScale = edge ? engine.dcNyquistScale : engine.scale;
+            const float real = buffer[2 * bin], imag = buffer[2 * bin + 1];
+            const float power = (real * real + imag * imag) * binScale * binScale;
+
+            const float levelDB = (power > MIN_MAGNITUDE * MIN_MAGNITUDE)
+                                   ? 10.0f * std::log10(power)
+                                   : Engine::MIN_MAGNITUDE_DB;
+            const float reductionDB = referenceReduction(engine, state, bin, levelDB);
+            state.gainReductionsDB[bin] = reductionDB;
+
+            const float gain = juce::Decibels::decibelsToGain(-reductionDB);
+            buffer[2 * bin] = real * gain;
+            buffer[2 * bin + 1] = imag * gain;
+        }
+    }
+};
+
+namespace {
+    // The per-block overhead around the frames, at host buffer sizes
+    void benchmarkBlockSizes() {
+        std::printf("Block sizes (4096-point frames, 4x overlap, stereo)\n");
+        for(const int blockSize : {32, 64, 128, 256, 512, 1024, 2048, 4096}) {
+            const auto timing = measureEngine<4096>({.blockSize = blockSize});
+            std::printf("  %4d samples: %.3f%% of real time", blockSize,
+                        100.0 * timing.realTimeFraction);
+            if(timing.idleNanoseconds < 1e30)
+                std::printf(", %.2f ns per sample frame without a frame", timing.idleNanoseconds);
+            std::printf("\n");
+        }
+    }
+
+    // What each selectable resolution costs and the latency it reports, at a typical host block
+    template <size_t FFT_SIZE> void reportResolution() {
+        const auto timing = measureEngine<FFT_SIZE>({});
+        std::printf("  %5zu points: %.3f%% of real time, %.1f ms latency\n", FFT_SIZE,
+                    100.0 * timing.realTimeFraction, 1000.0 * (FFT_SIZE - 1) / SAMPLE_RATE);
+    }
+
+    void benchmarkResolutions() {
+        std::printf("Resolutions (512-sample blocks, 4x overlap, stereo)\n");
+        reportResolution<512>();
+        reportResolution<1024>();
+        reportResolution<2048>();
+        reportResolution<4096>();
+        reportResolution<8192>();
+        reportResolution<16384>();
+    }
+
+    // The overlap factors offered at prepare time, at the default resolution
+    void benchmarkOverlaps() {
+        std::printf("Overlaps (4096-point frames, 512-sample blocks, stereo)\n");
+        for(const int overlap : {2, 4, 8}) {
+            const auto timing = measureEngine<4096>({.overlap = overlap});
+            std::printf("  %dx: %.3f%% of real time\n", overlap, 100.0 * timing.realTimeFraction);
+        }
+    }
+
+    // The same engine with the display subscribed (editor open) and without (editor closed)
+    void benchmarkAnalysis() {
+        std::printf("Analysis (4096-point frames, 512-sample blocks, 4x overlap, stereo)\n");
+        for(const bool analysis : {false, true}) {
+            const auto timing = measureEngine<4096>({.analysis = analysis});
+            std::printf("  %s: %.3f%% of real time\n", analysis ? "on " : "off",
+                        100.0 * timing.realTimeFraction);
+        }
+    }
+
+    // The audio thread's share of the analysis per frame: the stereo average of the dry, wet and
+    // gain reduction spectra written into the back slots, then all three published. No reader runs
+    // alongside, so this is the uncontended cost.
+    void benchmarkPublish() {
+        constexpr size_t NUM_BINS = 4096 / 2 + 1;
+        constexpr int NUM_FRAMES = 20000;
+        using Spectrum = std::array<float, NUM_BINS>;
+
+        std::array<Spectrum, NUM_CHANNELS> channelSpectra;
+        juce::Random random(1);
+        for(auto &spectrum : channelSpectra)
+            for(auto &bin : spectrum)
+                bin = random.nextFloat();
+
+        auto snapshots = std::make_unique<std::array<TripleBuffer<Spectrum>, 3>>();
+        const float channelWeight = 1.0f / NUM_CHANNELS;
+
+        auto averageInto = [&](Spectrum &back) {
+            juce::FloatVectorOperations::multiply(back.data(), channelSpectra[0].data(),
+                                                  channelWeight, (int)NUM_BINS);
+            for(size_t ch = 1; ch < NUM_CHANNELS; ++ch)
+                juce::FloatVectorOperations::addWithMultiply(
+                 back.data(), channelSpectra[ch].data(), channelWeight, (int)NUM_BINS);
+        };
+
+        auto timeFrames = [&](bool fill) {
+            double best = 1e30;
+            for(int repetition = 0; repetition < REPETITIONS; ++repetition) {
+                const auto start = Clock::now();
+                for(int frame = 0; frame < NUM_FRAMES; ++frame) {
+                    for(auto &snapshot : *snapshots)
+                        if(fill)
+                            averageInto(snapshot.write());
+                    for(auto &snapshot : *snapshots)
+                        snapshot.publish();
+                }
+                best = std::min(best, secondsSince(start));
+            }
+            return best * 1e9 / NUM_FRAMES;
+        };
+
+        std::printf("Analysis publish (4096-point frames, stereo, three spectra)\n");
+        std::printf("  fill and publish: %.0f ns per frame\n", timeFrames(true));
+        std::printf("  publish alone:    %.1f ns per frame\n", timeFrames(false));
+    }
+
+    // The input FIFO's life per hop: runs pushed up to the hop boundary, the frame windowed out,
+    // then the hop dropped. Reading the frame through the contiguous view is what the engine does;
+    // reading it sample by sample through operator[] is the wrapping access it replaced.
+    void benchmarkFifo() {
+        constexpr size_t FFT_SIZE = 4096, HOP = FFT_SIZE / 4, RUN = 256, NUM_HOPS = 2000;
+
+        std::vector<float> window(FFT_SIZE), frame(FFT_SIZE), input(HOP * NUM_HOPS);
+        for(size_t i = 0; i < FFT_SIZE; ++i)
+            window[i]
+             = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)i / FFT_SIZE);
+        juce::Random random(1);
+        for(auto &sample : input)
+            sample = random.nextFloat() - 0.5f;
+
+        auto timeHops = [&](bool contiguous) {
+            double best = 1e30;
+            float sink = 0.0f;
+            for(int repetition = 0; repetition < REPETITIONS; ++repetition) {
+                auto fifo = std::make_unique<CircularBuffer<float, FFT_SIZE>>();
+                const auto start = Clock::now();
+                for(size_t hop = 0; hop < NUM_HOPS; ++hop) {
+                    for(size_t run = 0; run < HOP; run += RUN)
+                        fifo->push(input.data() + hop * HOP + run, RUN);
+                    if(fifo->size() < FFT_SIZE)
+                        continue;
+
+                    if(contiguous) {
+                        const auto latest = fifo->latest(FFT_SIZE);
+                        for(size_t i = 0; i < FFT_SIZE; ++i)
+                            frame[i] = latest[i] * window[i];
+                    } else {
+                        for(size_t i = 0; i < FFT_SIZE; ++i)
+                            frame[i] = (*fifo)[i] * window[i];
+                    }
+                    fifo->discard(HOP);
+                    sink += frame[hop % FFT_SIZE];
+                }
+                best = std::min(best, secondsSince(start));
+            }
+            // Keeps the frames observable so the copies are not optimised away
+            if(sink == 0.0f)
+                std::printf(" ");
+            return best * 1e9 / NUM_HOPS;
+        };
+
+        std::printf("Input FIFO (4096-point frames, 4x overlap, pushes of 256)\n");
+        std::printf("  contiguous view: %.0f ns per hop\n", timeHops(true));
+        std::printf("  indexed reads:   %.0f ns per hop\n", timeHops(false));
+    }
+
+    // A frame's round trip through each backend: the windowed frame copied in, then one forward
+    // and one inverse transform. JuceFFT runs whichever engine JUCE was built with, so on a build
+    // without vDSP, IPP, MKL or FFTW this is the portable fallback Auto replaces with RadixFFT.
+    template <size_t SIZE> void reportFFTBackends() {
+        constexpr size_t NUM_FRAMES = ((size_t)1 << 23) / SIZE; // about 8M samples per run
+
+        std::vector<float> frame(SIZE), data(2 * SIZE);
+        juce::Random random(1);
+        for(auto &sample : frame)
+            sample = random.nextFloat() - 0.5f;
+
+        auto timeFrames = [&](const auto &fft) {
+            double best = 1e30;
+            float sink = 0.0f;
+            for(int repetition = 0; repetition < REPETITIONS; ++repetition) {
+                const auto start = Clock::now();
+                for(size_t i = 0; i < NUM_FRAMES; ++i) {
+                    std::copy(frame.begin(), frame.end(), data.begin());
+                    fft.forward(data.data());
+                    fft.inverse(data.data());
+                    sink += data[i % SIZE];
+                }
+                best = std::min(best, secondsSince(start));
+            }
+            // Keeps the results observable so the transforms are not optimised away
+            if(sink == 0.0f)
+                std::printf(" ");
+            return best * 1e9 / NUM_FRAMES;
+        };
+
+        auto radix = std::make_unique<FFTBackend::RadixFFT<SIZE>>();
+        auto juceFFT = std::make_unique<FFTBackend::JuceFFT<SIZE>>();
+        const double radixNs = timeFrames(*radix), juceNs = timeFrames(*juceFFT);
+        std::printf("  %5zu points: RadixFFT %7.2f us, JuceFFT %7.2f us, %.2fx\n", SIZE,
+                    radixNs / 1e3, juceNs / 1e3, juceNs / radixNs);
+    }
+
+    void benchmarkFFTBackends() {
+        std::printf("FFT backends (forward and inverse per frame)\n");
+        reportFFTBackends<512>();
+        reportFFTBackends<1024>();
+        reportFFTBackends<2048>();
+        reportFFTBackends<4096>();
+        reportFFTBackends<8192>();
+        reportFFTBackends<16384>();
+        reportFFTBackends<32768>();
+    }
+
+    // The bin loop of one channel's frame, per bin through the polar form as it was, with the
+    // gain applied to the real and imaginary parts directly, and as the engine's vector kernels
+    template <size_t FFT_SIZE> void reportGainKernel() {
+        using Benchmark = SpectralDynamicsBenchmark;
+        std::printf("  %5zu points: polar %.1f us, rectangular %.1f us, kernel %.1f us per frame\n",
+                    FFT_SIZE, Benchmark::timeBinLoop<FFT_SIZE>(Benchmark::POLAR) / 1e3,
+                    Benchmark::timeBinLoop<FFT_SIZE>(Benchmark::RECTANGULAR) / 1e3,
+                    Benchmark::timeBinLoop<FFT_SIZE>(Benchmark::KERNEL) / 1e3);
+    }
+
+    void benchmarkGainKernel() {
+        std::printf("Gain kernel (compressor, one channel)\n");
+        reportGainKernel<4096>();
+        reportGainKernel<16384>();
+    }
+
+    // The compressor's bin loop with the fixed release, and with the program-dependent release
+    // that follows a slow envelope as well
+    template <size_t FFT_SIZE> void reportAutoRelease() {
+        using Benchmark = SpectralDynamicsBenchmark;
+        const double fixed = Benchmark::timeBinLoop<FFT_SIZE>(Benchmark::KERNEL, COMPRESSOR, false);
+        const double automatic
+         = Benchmark::timeBinLoop<FFT_SIZE>(Benchmark::KERNEL, COMPRESSOR, true);
+        std::printf("  %5zu points: fixed %.1f us, auto %.1f us per frame (%+.1f%%)\n", FFT_SIZE,
+                    fixed / 1e3, automatic / 1e3, 100.0 * (automatic / fixed - 1.0));
+    }
+
+    void benchmarkAutoRelease() {
+        std::printf("Auto release (compressor kernel, one channel)\n");
+        reportAutoRelease<4096>();
+        reportAutoRelease<16384>();
+    }
+
+    // The bin loop with the mode dispatched once per frame to a kernel specialised for it, and
+    // with the mode switched on for every bin
+    void benchmarkModeDispatch() {
+        using Benchmark = SpectralDynamicsBenchmark;
+        std::printf("Mode dispatch (4096-point frames, one channel)\n");
+        for(const auto compressorMode : {COMPRESSOR, EXPANDER, CLIPPER, GATE}) {
+            std::printf("  %-10s dispatched per frame %.1f us, switched per bin %.1f us\n",
+                        modeNames[compressorMode],
+                        Benchmark::timeBinLoop<4096>(Benchmark::KERNEL, compressorMode) / 1e3,
+                        Benchmark::timeBinLoop<4096>(Benchmark::SWITCHED, compressorMode) / 1e3);
+        }
+    }
+
+    // A session where most of the audio is digital silence, as on tracks that only play now and
+    // then. Frames of silence with a drained overlap-add tail are skipped.
+    void benchmarkSilence() {
+        std::printf("Silence (4096-point frames, 512-sample blocks, 4x overlap, stereo)\n");
+        for(const double silentFraction : {0.0, 0.8}) {
+            const auto timing = measureEngine<4096>({.silentFraction = silentFraction});
+            std::printf("  %2.0f%% silent: %.3f%% of real time\n", 100.0 * silentFraction,
+                        100.0 * timing.realTimeFraction);
+        }
+    }
+
+    // Offline bounces run the engine on a worker pool: a bed's channels concurrently, and for the
+    // largest frames a channel's bins in ranges. With fewer cores than threads this shows the
+    // pool's overhead rather than its gain.
+    template <size_t FFT_SIZE, int CHANNELS> void reportThreadScaling(const char *name) {
+        std::printf("  %s, %zu points:\n", name, FFT_SIZE);
+        double serial = 0.0;
+        for(int numThreads = 1; numThreads <= 8; ++numThreads) {
+            std::unique_ptr<WorkerPool> pool;
+            if(numThreads > 1)
+                pool = std::make_unique<WorkerPool>(numThreads - 1);
+
+            const auto timing = measureEngine<FFT_SIZE, CHANNELS>(
+             {.blockSize = 4096, .workerPool = pool.get()});
+            if(numThreads == 1)
+                serial = timing.realTimeFraction;
+            std::printf("    %d thread%s: %.3f%% of real time, %.2fx\n", numThreads,
+                        numThreads == 1 ? " " : "s", 100.0 * timing.realTimeFraction,
+                        serial / timing.realTimeFraction);
+        }
+    }
+
+    void benchmarkThreadScaling() {
+        std::printf("Thread scaling (4096-sample blocks, 4x overlap, %u hardware threads)\n",
+                    std::thread::hardware_concurrency());
+        reportThreadScaling<4096, 8>("7.1 unlinked");
+        reportThreadScaling<16384, 2>("Stereo");
+    }
+
+    // One engine sized to a bed, its pairs linked as the plugin groups them, against the stereo
+    // instances it replaces, each a linked pair of the same bed
+    template <int CHANNELS> void reportBed(const char *name, const ChannelGroups &groups) {
+        const int numPairs = CHANNELS / 2;
+        for(const bool analysis : {false, true}) {
+            const auto bed = measureEngine<4096, CHANNELS>(
+             {.analysis = analysis, .link = LINK_GROUPS, .layoutGroups = groups});
+            const auto pair = measureEngine<4096, 2>({.analysis = analysis, .link = LINK_ALL});
+            std::printf("  %s, analysis %s: one instance %.3f%%, %d stereo instances %.3f%% of "
+                        "real time\n",
+                        name, analysis ? "on " : "off", 100.0 * bed.realTimeFraction, numPairs,
+                        100.0 * numPairs * pair.realTimeFraction);
+        }
+    }
+
+    void benchmarkBeds() {
+        std::printf("Beds (4096-point frames, 512-sample blocks, 4x overlap, linked)\n");
+        reportBed<6>("5.1", {.sizes = {2, 1, 1, 2}, .numGroups = 4});
+        reportBed<8>("7.1", {.sizes = {2, 1, 1, 2, 2}, .numGroups = 5});
+    }
+
+    // The engine with its analysis on, alone and while another thread polls the snapshots the
+    // displays read. Only meaningful with a core free for the reader.
+    void benchmarkDisplayReader() {
+        std::printf("Display reader (4096-point frames, 512-sample blocks, 4x overlap, analysis "
+                    "on, %u hardware threads)\n",
+                    std::thread::hardware_concurrency());
+        for(const bool reader : {false, true}) {
+            const auto timing = measureEngine<4096>({.analysis = true, .displayReader = reader});
+            std::printf("  %-12s %.3f%% of real time\n", reader ? "with reader:" : "no reader:",
+                        100.0 * timing.realTimeFraction);
+        }
+    }
+
+    // What one more plugin instance costs to create: the engines for every resolution, allocated
+    // and prepared for a stereo bus. The first also builds the windows, twiddles and bin tables
+    // that later instances with the same settings share.
+    void benchmarkInstances() {
+        constexpr int NUM_INSTANCES = 16;
+        const ChannelGroups stereo{.sizes = {2}, .numGroups = 1};
+        std::vector<std::unique_ptr<GaussianResponseCurve>> curves;
+        std::vector<std::unique_ptr<MultiResolutionProcessor>> instances;
+        curves.reserve(NUM_INSTANCES);
+        instances.reserve(NUM_INSTANCES);
+
+        double firstSeconds = 0.0, laterSeconds = 0.0;
+        size_t firstBytes = 0, laterBytes = 0;
+        for(int i = 0; i < NUM_INSTANCES; ++i) {
+            const size_t bytesBefore = allocatedBytes.load();
+            const auto start = Clock::now();
+            curves.push_back(std::make_unique<GaussianResponseCurve>());
+            instances.push_back(std::make_unique<MultiResolutionProcessor>(*curves.back()));
+            instances.back()->prepareToPlay(SAMPLE_RATE, 512, 4, NUM_CHANNELS, stereo);
+            const double elapsed = secondsSince(start);
+            const size_t bytes = allocatedBytes.load() - bytesBefore;
+
+            if(i == 0) {
+                firstSeconds = elapsed;
+                firstBytes = bytes;
+            } else {
+                laterSeconds += elapsed;
+                laterBytes += bytes;
+            }
+        }
+
+        const int numLater = NUM_INSTANCES - 1;
+        std::printf("Instances (stereo, 4x overlap, all resolutions)\n");
+        std::printf("  first: %.2f ms, %.2f MB allocated\n", 1e3 * firstSeconds,
+                    (double)firstBytes / (1 << 20));
+        std::printf("  each of %d more: %.2f ms, %.2f MB allocated\n", numLater,
+                    1e3 * laterSeconds / numLater, (double)laterBytes / numLater / (1 << 20));
+    }
+} // namespace
+
+int main() {
+    benchmarkBlockSizes();
+    benchmarkFifo();
+    benchmarkResolutions();
+    benchmarkOverlaps();
+    benchmarkPublish();
+    benchmarkAnalysis();
+    benchmarkFFTBackends();
+    benchmarkGainKernel();
+    benchmarkModeDispatch();
+    benchmarkAutoRelease();
+    benchmarkSilence();
+    benchmarkThreadScaling();
+    benchmarkBeds();
+    benchmarkDisplayReader();
+    benchmarkInstances();
+    return 0;
+}
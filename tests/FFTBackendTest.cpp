@@ -0,0 +1,86 @@
+#include <JuceHeader.h>
+#include "FFTBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Checks the bundled RadixFFT against juce::dsp::FFT, whichever engine JUCE was built with, at
+// every size from 16 to 32768 points: the spectra must agree bin by bin, and a frame must survive
+// a round trip through either backend's inverse.
+class FFTBackendTest : public juce::UnitTest {
+  public:
+    FFTBackendTest() : juce::UnitTest("FFT backends", "Spectrix") {}
+
+    void runTest() override {
+        beginTest("RadixFFT against JuceFFT");
+        testSizes<16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768>();
+    }
+
+  private:
+    // Relative to the largest bin, or to the largest sample for the round trips. Float transforms
+    // lose about one rounding error per stage, so this holds up to 32768 points with room to spare.
+    static constexpr double SPECTRUM_TOLERANCE = 1e-5;
+    static constexpr double ROUND_TRIP_TOLERANCE = 1e-5;
+
+    template <size_t... SIZES> void testSizes() { (testSize<SIZES>(), ...); }
+
+    template <size_t SIZE> void testSize() {
+        FFTBackend::RadixFFT<SIZE> radix;
+        FFTBackend::JuceFFT<SIZE> juceFFT;
+
+        juce::Random random((juce::int64)SIZE);
+        std::vector<float> signal(SIZE);
+        for(auto &sample : signal)
+            sample = 2.0f * random.nextFloat() - 1.0f;
+
+        std::vector<float> radixData(2 * SIZE, 0.0f), juceData(2 * SIZE, 0.0f);
+        std::copy(signal.begin(), signal.end(), radixData.begin());
+        std::copy(signal.begin(), signal.end(), juceData.begin());
+        radix.forward(radixData.data());
+        juceFFT.forward(juceData.data());
+
+        // Bins 0 to SIZE / 2 as (real, imag) pairs
+        const size_t numValues = SIZE + 2;
+        double peak = 0.0, maxDifference = 0.0;
+        for(size_t i = 0; i < numValues; ++i) {
+            peak = std::max(peak, (double)std::abs(juceData[i]));
+            maxDifference = std::max(maxDifference, (double)std::abs(radixData[i] - juceData[i]));
+        }
+
+        const double spectrumError = maxDifference / peak;
+        const double radixRoundTrip = roundTripError(radix, radixData, signal);
+        const double juceRoundTrip = roundTripError(juceFFT, juceData, signal);
+        // Each backend's inverse of the other's spectrum
+        const double crossRoundTrip = std::max(roundTripError(juceFFT, radixData, signal),
+                                               roundTripError(radix, juceData, signal));
+
+        logMessage(juce::String(SIZE) + " points: spectrum error " + juce::String(spectrumError)
+                   + ", round trip errors " + juce::String(radixRoundTrip) + " (RadixFFT), "
+                   + juce::String(juceRoundTrip) + " (JuceFFT), " + juce::String(crossRoundTrip)
+                   + " (crossed)");
+
+        const juce::String size(SIZE);
+        expectLessOrEqual(spectrumError, SPECTRUM_TOLERANCE, size + " spectrum");
+        expectLessOrEqual(radixRoundTrip, ROUND_TRIP_TOLERANCE, size + " RadixFFT round trip");
+        expectLessOrEqual(juceRoundTrip, ROUND_TRIP_TOLERANCE, size + " JuceFFT round trip");
+        expectLessOrEqual(crossRoundTrip, ROUND_TRIP_TOLERANCE, size + " crossed round trip");
+    }
+
+    // Inverts a copy of spectrum, which inverse() may overwrite past its result
+    template <typename FFT>
+    static double roundTripError(const FFT &fft, const std::vector<float> &spectrum,
+                                 const std::vector<float> &signal) {
+        std::vector<float> data(spectrum);
+        fft.inverse(data.data());
+
+        double peak = 0.0, maxDifference = 0.0;
+        for(size_t i = 0; i < signal.size(); ++i) {
+            peak = std::max(peak, (double)std::abs(signal[i]));
+            maxDifference = std::max(maxDifference, (double)std::abs(data[i] - signal[i]));
+        }
+
+        return maxDifference / peak;
+    }
+};
+
+static FFTBackendTest fftBackendTest;
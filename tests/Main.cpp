@@ -0,0 +1,14 @@
+#include <JuceHeader.h>
+
+// Runs every Spectrix unit test; a non-zero exit code tells ctest that one of them failed.
+int main() {
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("Spectrix");
+
+    int failures = 0;
+    for(int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,192 @@
+#include <JuceHeader.h>
+#include "SpectralCompressor.h"
+#include <array>
+#include <cmath>
+#include <memory>
+
+// Checks the vectorised gain computer against a plain scalar reference in double: std::log10
+// levels, the textbook soft knee with branches and std::pow gains. The kernels trade the libm
+// calls for FastMath approximations, and these tolerances bound what that is allowed to cost.
+class SpectralDynamicsAccuracyTest : public juce::UnitTest {
+  public:
+    SpectralDynamicsAccuracyTest() : juce::UnitTest("Spectral dynamics accuracy", "Spectrix") {}
+
+    void runTest() override {
+        engine = std::make_unique<Engine>(responseCurve);
+        engine->prepareToPlay(48000.0, 4);
+
+        beginTest("Levels");
+        testLevels();
+
+        beginTest("Gain reduction");
+        for(const auto mode : {COMPRESSOR, EXPANDER, CLIPPER, GATE})
+            testGainReduction(mode, false);
+        testGainReduction(COMPRESSOR, true);
+
+        beginTest("Gains");
+        testGains();
+
+        engine.reset();
+    }
+
+  private:
+    using Engine = SpectralDynamicsProcessor<1024, 1>;
+    static constexpr size_t NUM_BINS = Engine::NUM_BINS;
+    using BinArray = std::array<float, NUM_BINS>;
+
+    // FastMath::log2 is within 4e-6 of log2, i.e. 1.2e-5 dB
+    static constexpr double LEVEL_TOLERANCE_DB = 1e-4;
+    // The envelopes smooth the level error and add float rounding of their own
+    static constexpr double REDUCTION_TOLERANCE_DB = 1e-3;
+    // FastMath::exp2 is within 3e-7; the rest is the rounding of its argument up to 100 dB
+    static constexpr double GAIN_TOLERANCE = 1e-5;
+
+    static constexpr float KNEE_DB = 6.0f;
+    static constexpr float RATIO = 4.0f;
+    static constexpr float SHIFT_DB = -3.0f;
+    static constexpr int NUM_HOPS = 200;
+
+    // The power of random bins from far below the level floor to well above full scale
+    void testLevels() {
+        juce::Random random(1);
+        auto state = std::make_unique<Engine::ChannelState>();
+        std::array<float, 1024 * 2> buffer{};
+
+        for(size_t bin = 0; bin < NUM_BINS; ++bin) {
+            const bool edge = bin == 0 || bin == NUM_BINS - 1;
+            const double binScale = edge ? engine->dcNyquistScale : engine->scale;
+            const double levelDB = -130.0 + 150.0 * random.nextDouble();
+            const double magnitude = std::pow(10.0, levelDB / 20.0) / binScale;
+            const double phase
+             = edge ? 0.0 : juce::MathConstants<double>::twoPi * random.nextDouble();
+            buffer[2 * bin] = (float)(magnitude * std::cos(phase));
+            buffer[2 * bin + 1] = (float)(magnitude * std::sin(phase));
+        }
+
+        engine->computeLevels(*state, buffer, 0, NUM_BINS);
+
+        double maxErrorDB = 0.0;
+        for(size_t bin = 0; bin < NUM_BINS; ++bin) {
+            const bool edge = bin == 0 || bin == NUM_BINS - 1;
+            const double binScale = edge ? engine->dcNyquistScale : engine->scale;
+            const double re = buffer[2 * bin], im = buffer[2 * bin + 1];
+            const double power = (re * re + im * im) * binScale * binScale;
+            const double expectedDB = std::max(10.0 * std::log10(power + Engine::MIN_POWER),
+                                               (double)Engine::MIN_MAGNITUDE_DB);
+            maxErrorDB = std::max(maxErrorDB, std::abs(state->levelsDB[bin] - expectedDB));
+        }
+
+        logMessage("Level error: " + juce::String(maxErrorDB) + " dB");
+        expectLessOrEqual(maxErrorDB, LEVEL_TOLERANCE_DB, "levels");
+    }
+
+    // Random levels every hop against random thresholds, through per-bin ballistics
+    void testGainReduction(CompressorMode mode, bool autoRelease) {
+        juce::Random random(2);
+        engine->mode = mode;
+        engine->autoRelease = autoRelease;
+        engine->hopShiftDB = SHIFT_DB;
+        engine->updateCurve(KNEE_DB, RATIO);
+
+        BinArray thresholdsDB, attack, release, slow;
+        for(size_t i = 0; i < NUM_BINS; ++i) {
+            thresholdsDB[i] = -60.0f + 60.0f * random.nextFloat();
+            attack[i] = 0.5f + 0.49f * random.nextFloat();
+            release[i] = 0.5f + 0.499f * random.nextFloat();
+            slow[i] = 0.9f + 0.0999f * random.nextFloat();
+        }
+
+        BinArray levelsDB, envelopes{}, slowEnvelopes{}, gainReductionsDB;
+        std::array<double, NUM_BINS> expectedEnvelopes{}, expectedSlowEnvelopes{};
+        double maxErrorDB = 0.0;
+
+        for(int hop = 0; hop < NUM_HOPS; ++hop) {
+            for(auto &level : levelsDB)
+                level = -100.0f + 110.0f * random.nextFloat();
+
+            engine->computeGainReduction(levelsDB, thresholdsDB, envelopes, slowEnvelopes,
+                                         gainReductionsDB,
+                                         {attack.data(), release.data(), slow.data()}, 0,
+                                         NUM_BINS);
+
+            for(size_t i = 0; i < NUM_BINS; ++i) {
+                const double overDB = (double)levelsDB[i] - ((double)thresholdsDB[i] + SHIFT_DB);
+                double targetDB = referenceTarget(mode, overDB);
+                double expectedDB = targetDB;
+
+                if(mode != CLIPPER) {
+                    if(autoRelease) {
+                        expectedSlowEnvelopes[i]
+                         = slow[i] * expectedSlowEnvelopes[i] + (1.0 - slow[i]) * targetDB;
+                        targetDB = std::max(targetDB, expectedSlowEnvelopes[i]);
+                    }
+
+                    const double coeff = targetDB > expectedEnvelopes[i] ? attack[i] : release[i];
+                    expectedEnvelopes[i] = coeff * expectedEnvelopes[i] + (1.0 - coeff) * targetDB;
+                    expectedDB = expectedEnvelopes[i];
+                }
+
+                maxErrorDB = std::max(maxErrorDB, std::abs(gainReductionsDB[i] - expectedDB));
+            }
+        }
+
+        const juce::String name = juce::String(modeNames[mode]) + (autoRelease ? " (auto)" : "");
+        logMessage(name + " reduction error: " + juce::String(maxErrorDB) + " dB");
+        expectLessOrEqual(maxErrorDB, REDUCTION_TOLERANCE_DB, name);
+    }
+
+    // Reductions from a 40 dB boost to past the mute floor
+    void testGains() {
+        BinArray gainReductionsDB, gains;
+        for(size_t i = 0; i < NUM_BINS; ++i)
+            gainReductionsDB[i] = -40.0f + 150.0f * (float)i / (float)(NUM_BINS - 1);
+
+        Engine::computeGains(gainReductionsDB, gains, 0, NUM_BINS);
+
+        double maxError = 0.0;
+        bool mutedExactly = true;
+        for(size_t i = 0; i < NUM_BINS; ++i) {
+            if(gainReductionsDB[i] >= -Engine::MIN_MAGNITUDE_DB) {
+                mutedExactly = mutedExactly && gains[i] == 0.0f;
+                continue;
+            }
+
+            const double expected = std::pow(10.0, -gainReductionsDB[i] / 20.0);
+            maxError = std::max(maxError, std::abs(gains[i] - expected) / expected);
+        }
+
+        logMessage("Relative gain error: " + juce::String(maxError));
+        expectLessOrEqual(maxError, GAIN_TOLERANCE, "gains");
+        expect(mutedExactly, "reductions past the floor mute");
+    }
+
+    static double referenceTarget(CompressorMode mode, double overDB) {
+        switch(mode) {
+        case COMPRESSOR:
+            return referenceCurve(overDB);
+        case EXPANDER:
+            return -referenceCurve(overDB);
+        case CLIPPER:
+            return std::max(overDB, 0.0);
+        default:
+            return overDB < 0.0 ? Engine::GATE_REDUCTION_DB : 0.0;
+        }
+    }
+
+    // The soft-knee static curve, piecewise as usually written
+    static double referenceCurve(double overDB) {
+        const double slope = 1.0 - 1.0 / RATIO;
+        if(2.0 * overDB < -KNEE_DB)
+            return 0.0;
+        if(2.0 * overDB <= KNEE_DB)
+            return slope * (overDB + KNEE_DB / 2.0) * (overDB + KNEE_DB / 2.0) / (2.0 * KNEE_DB);
+        return slope * overDB;
+    }
+
+    static constexpr const char *modeNames[] = {"Compressor", "Expander", "Clipper", "Gate"};
+
+    GaussianResponseCurve responseCurve;
+    std::unique_ptr<Engine> engine;
+};
+
+static SpectralDynamicsAccuracyTest spectralDynamicsAccuracyTest;